@@ -12,75 +12,6 @@
 class OSC_X32FeedbackProcessor : public OSC_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-
-    enum X32Color
-    {
-        COLOR_INVALID = -1,
-        COLOR_OFF = 0,
-        COLOR_RED,
-        COLOR_GREEN,
-        COLOR_YELLOW,
-        COLOR_BLUE,
-        COLOR_MAGENTA,
-        COLOR_CYAN,
-        COLOR_WHITE
-    };
-
-    /*
-     * NOTE: Any changes made to rgbToColor here must also be mirrored in class
-     * XTouchDisplay_Midi_FeedbackProcessor in control_surface_midi_widgets.h
-     */
-    static int rgbToColor(int r, int g, int b)
-    {
-        // Doing a RGB to HSV conversion since HSV is better for light
-        // Converting RGB to floats between 0 and 1.0 (percentage)
-        float rf = r / 255.0f;
-        float gf = g / 255.0f;
-        float bf = b / 255.0f;
-
-        // Hue will be between 0 and 360 to represent the color wheel.
-        // Saturation and Value are a percentage (between 0 and 1.0)
-        float h, s, v, colorMin, delta;
-        v = (float) max(max(rf, gf), bf);
-
-        // If value is less than this percentage, LCD should be off.
-        if (v <= 0.10)
-            return COLOR_WHITE; // This could be OFF, but that would show nothing.
-
-        colorMin = min(min(rf, gf), bf);
-        delta = v - colorMin;
-        // Don't need divide by zero check since if value is 0 it will return COLOR_OFF above.
-        s = delta / v;
-
-        // If saturation is less than this percentage, LCD should be white.
-        if (s <= 0.10)
-            return COLOR_WHITE;
-
-        // Now we have a valid color. Figure out the hue and return the closest X-Touch value.
-        if (rf >= v)        h =  (gf - bf) / delta;
-        else if (gf >= v)   h = ((bf - rf) / delta) + 2.0f;
-        else                h = ((rf - gf) / delta) + 4.0f;
-
-        h *= 60.0;
-        if (h < 0)  h += 360.0;
-
-        // The numbers represent the hue from 0-360.
-        if (h >= 330 || h < 20)
-            return COLOR_RED;
-        if (h >= 250)
-            return COLOR_MAGENTA;
-        if (h >= 210)
-            return COLOR_BLUE;
-        if (h >= 160)
-            return COLOR_CYAN;
-        if (h >= 80)
-            return COLOR_GREEN;
-        if (h >= 20)
-            return COLOR_YELLOW;
-        return COLOR_WHITE; // failsafe
-    }
-
 public:
     OSC_X32FeedbackProcessor(CSurfIntegrator *const csi, OSC_ControlSurface *surface, Widget *widget, const string &oscAddress) : OSC_FeedbackProcessor(csi, surface, widget, oscAddress)  {}
     ~OSC_X32FeedbackProcessor() {}
@@ -93,7 +24,7 @@ public:
         {
             lastColor_ = color;
 
-            surface_->SendOSCMessage(this, oscAddress_.c_str(), rgbToColor(color.r, color.g, color.b));
+            surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, ColorPalettes::GetScribbleStripColor(color.r, color.g, color.b));
         }
     }
 };
@@ -114,11 +45,35 @@ public:
         
         if (oscAddress_.find("/-stat/selidx/") != string::npos  && value != 0.0)
         {
+            static const int selectIndexSymbol = InternSymbol("/-stat/selidx");
+            
             string selectIndex = oscAddress_.substr(oscAddress_.find_last_of('/') + 1);
-            surface_->SendOSCMessage(this, "/-stat/selidx", (int)atoi(selectIndex.c_str()));
+            surface_->SendOSCMessage(this, "/-stat/selidx", selectIndexSymbol, (int)atoi(selectIndex.c_str()));
         }
         else
-            surface_->SendOSCMessage(this, oscAddress_.c_str(), (int)value);
+            surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, (int)value);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Control_OSC_MessageGenerator : public CSIMessageGenerator
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // A plain OSC Control can be a button or a fader, only its values tell which. A button sends 0 and 1,
+    // the first value in between marks a fader (or pot, XY pad) and its batches are coalesced from then on.
+private:
+    bool isAbsolute_ = false;
+    
+public:
+    Control_OSC_MessageGenerator(CSurfIntegrator *const csi, Widget *widget) : CSIMessageGenerator(csi, widget) {}
+    ~Control_OSC_MessageGenerator() {}
+    
+    virtual bool GetIsAbsolute() override { return isAbsolute_; }
+    
+    virtual void AddInputValue(double value) override
+    {
+        if (value > 0.0 && value < 1.0)
+            isAbsolute_ = true;
     }
 };
 
@@ -130,6 +85,8 @@ public:
     X32_Fader_OSC_MessageGenerator(CSurfIntegrator *const csi, Widget *widget) : CSIMessageGenerator(csi, widget) {}
     ~X32_Fader_OSC_MessageGenerator() {}
 
+    virtual bool GetIsAbsolute() override { return true; }
+
     virtual void ProcessMessage(double value) override
     {
         if      (value >= 0.5)    value = value *  40.0 - 30.0;  // max dB value: +10.
@@ -166,7 +123,7 @@ public:
         else if (value <= 10.0) value = (value + 30.0) /  40.0;
 
         if ((GetTickCount() - GetWidget()->GetLastIncomingMessageTime()) >= 30)
-            surface_->SendOSCMessage(this, oscAddress_.c_str(), value);
+            surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, value);
     }
 };
 
@@ -213,7 +170,7 @@ public:
     
     virtual void ForceValue(const PropertyList &properties, double value) override
     {
-        surface_->SendOSCMessage(this, oscAddress_.c_str(), 64);
+        surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, 64);
     }
 };
 
@@ -489,7 +489,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
             return volToNormalized(vol);
         }
         else
@@ -582,7 +582,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
             return VAL2DB(vol);
         }
         else
@@ -625,7 +625,7 @@ public:
             if (GetPanMode(track) != 6)
             {
                 double vol, pan = 0.0;
-                GetTrackUIVolPan(track, &vol, &pan);
+                context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
                 return panToNormalized(pan);
             }
         }
@@ -675,7 +675,7 @@ public:
             if (GetPanMode(track) != 6)
             {
                 double vol, pan = 0.0;
-                GetTrackUIVolPan(track, &vol, &pan);
+                context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
                 context->UpdateWidgetValue(pan  *100.0);
             }
         }
@@ -975,7 +975,7 @@ public:
             else
             {
                 double vol, pan = 0.0;
-                GetTrackUIVolPan(track, &vol, &pan);
+                context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
                 return panToNormalized(pan);
             }
         }
@@ -1098,7 +1098,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_RECARM");
+            return context->GetPage()->GetTrackStateSnapshot().GetRecArm(track);
         else
             return 0.0;
     }
@@ -1132,7 +1132,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext* context) override
     {
         if (MediaTrack* track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_RECARM");
+            return context->GetPage()->GetTrackStateSnapshot().GetRecArm(track);
         return 0.0;
     }
 
@@ -1151,16 +1151,17 @@ public:
         MediaTrack* track = context->GetTrack();
         if (!track) return;
 
-        int selCount = CountSelectedTracks(NULL);
-        bool isSelected = GetMediaTrackInfo_Value(track, "I_SELECTED") > 0;
+        const vector<MediaTrack *> &selectedTracks = context->GetPage()->GetSelectedTracks();
+        bool isSelected = context->GetPage()->GetIsTrackSelected(track);
         bool currentArm = GetMediaTrackInfo_Value(track, "I_RECARM") > 0;
         bool newArm = !currentArm;
 
-        if (selCount > 1 && isSelected)
+        if (selectedTracks.size() > 1 && isSelected)
         {
-            for (int i = 0; i < selCount; ++i)
+            DAWWriteTransaction transaction("CSI: Record arm selected tracks");
+            
+            for (MediaTrack* selTrack : selectedTracks)
             {
-                MediaTrack* selTrack = GetSelectedTrack(NULL, i);
                 CSurf_SetSurfaceRecArm(selTrack, CSurf_OnRecArmChange(selTrack, newArm), NULL);
             }
         }
@@ -1182,7 +1183,7 @@ public:
     {
         if (MediaTrack* track = context->GetTrack())
         {
-            double state = GetMediaTrackInfo_Value(track, "I_RECARM");
+            double state = context->GetPage()->GetTrackStateSnapshot().GetRecArm(track);
 
             if (state > 0.5)
                 context->UpdateWidgetValue("ARM");
@@ -1204,11 +1205,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-        {
-            bool mute = false;
-            GetTrackUIMute(track, &mute);
-            return mute;
-        }
+            return context->GetPage()->GetTrackStateSnapshot().GetIsMuted(track);
         else
             return 0.0;
     }
@@ -1244,11 +1241,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext* context) override
     {
         if (MediaTrack* track = context->GetTrack())
-        {
-            bool mute = false;
-            GetTrackUIMute(track, &mute);
-            return mute;
-        }
+            return context->GetPage()->GetTrackStateSnapshot().GetIsMuted(track);
         return 0.0;
     }
 
@@ -1267,17 +1260,18 @@ public:
         MediaTrack* track = context->GetTrack();
         if (!track) return;
 
-        int selCount = CountSelectedTracks(NULL);
-        bool isSelected = GetMediaTrackInfo_Value(track, "I_SELECTED") > 0;
+        const vector<MediaTrack *> &selectedTracks = context->GetPage()->GetSelectedTracks();
+        bool isSelected = context->GetPage()->GetIsTrackSelected(track);
         bool mute = false;
         GetTrackUIMute(track, &mute);
         bool newMute = !mute;
 
-        if (selCount > 1 && isSelected)
+        if (selectedTracks.size() > 1 && isSelected)
         {
-            for (int i = 0; i < selCount; ++i)
+            DAWWriteTransaction transaction("CSI: Mute selected tracks");
+            
+            for (MediaTrack* selTrack : selectedTracks)
             {
-                MediaTrack* selTrack = GetSelectedTrack(NULL, i);
                 CSurf_SetSurfaceMute(selTrack, CSurf_OnMuteChange(selTrack, newMute), NULL);
             }
         }
@@ -1298,7 +1292,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_SOLO") > 0 ? 1 : 0;
+            return context->GetPage()->GetTrackStateSnapshot().GetSolo(track) > 0 ? 1 : 0;
         else
             return 0.0;
     }
@@ -1343,7 +1337,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext* context) override
     {
         if (MediaTrack* track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_SOLO") > 0 ? 1 : 0;
+            return context->GetPage()->GetTrackStateSnapshot().GetSolo(track) > 0 ? 1 : 0;
         return 0.0;
     }
 
@@ -1362,16 +1356,17 @@ public:
         MediaTrack* track = context->GetTrack();
         if (!track) return;
 
-        int selCount = CountSelectedTracks(NULL);
-        bool isSelected = GetMediaTrackInfo_Value(track, "I_SELECTED") > 0;
+        const vector<MediaTrack *> &selectedTracks = context->GetPage()->GetSelectedTracks();
+        bool isSelected = context->GetPage()->GetIsTrackSelected(track);
         bool currentSolo = GetMediaTrackInfo_Value(track, "I_SOLO") > 0;
         bool newSolo = !currentSolo;
 
-        if (selCount > 1 && isSelected)
+        if (selectedTracks.size() > 1 && isSelected)
         {
-            for (int i = 0; i < selCount; ++i)
+            DAWWriteTransaction transaction("CSI: Solo selected tracks");
+            
+            for (MediaTrack* selTrack : selectedTracks)
             {
-                MediaTrack* selTrack = GetSelectedTrack(NULL, i);
                 if (selTrack && selTrack != GetMasterTrack(NULL))
                     CSurf_SetSurfaceSolo(selTrack, CSurf_OnSoloChange(selTrack, newSolo), NULL);
             }
@@ -1429,7 +1424,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_SELECTED");
+            return context->GetPage()->GetIsTrackSelected(track);
         else
             return 0.0;
     }
@@ -1448,7 +1443,7 @@ public:
 
         if (MediaTrack *track = context->GetTrack())
         {
-            CSurf_SetSurfaceSelected(track, CSurf_OnSelectedChange(track, ! GetMediaTrackInfo_Value(track, "I_SELECTED")), NULL);
+            CSurf_SetSurfaceSelected(track, CSurf_OnSelectedChange(track, ! context->GetPage()->GetIsTrackSelected(track)), NULL);
             context->GetPage()->OnTrackSelectionBySurface(track);
         }
     }
@@ -1464,7 +1459,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_SELECTED");
+            return context->GetPage()->GetIsTrackSelected(track);
         else
             return 0.0;
     }
@@ -1499,7 +1494,7 @@ public:
     virtual double GetCurrentNormalizedValue(ActionContext *context) override
     {
         if (MediaTrack *track = context->GetTrack())
-            return GetMediaTrackInfo_Value(track, "I_SELECTED");
+            return context->GetPage()->GetIsTrackSelected(track);
         else
             return 0.0;
     }
@@ -1516,43 +1511,33 @@ public:
     {
         if (value == ActionContext::BUTTON_RELEASE_MESSAGE_VALUE) return;
 
-        int currentlySelectedCount = 0;
-        int selectedTrackIndex = 0;
-        int trackIndex = 0;
+        MediaTrack *selectedTrack = context->GetPage()->GetSelectedTrack();
         
-       
-        for (int i = 1; i <= context->GetPage()->GetNumTracks(); ++i)
-        {
-            MediaTrack *currentTrack = context->GetPage()->GetTrackFromId(i);
-           
-            if (currentTrack == NULL)
-                continue;
-            
-            if (currentTrack == context->GetTrack())
-                trackIndex = i;
-            
-            if (GetMediaTrackInfo_Value(currentTrack, "I_SELECTED"))
-            {
-                selectedTrackIndex = i;
-                currentlySelectedCount++;
-            }
-        }
+        if (selectedTrack == NULL || context->GetTrack() == NULL)
+            return;
         
-        if (currentlySelectedCount != 1)
+        int selectedTrackIndex = context->GetPage()->GetIdFromTrack(selectedTrack);
+        int trackIndex = context->GetPage()->GetIdFromTrack(context->GetTrack());
+        
+        if (selectedTrackIndex < 1 || trackIndex < 1)
             return;
         
         int lowerBound = trackIndex < selectedTrackIndex ? trackIndex : selectedTrackIndex;
         int upperBound = trackIndex > selectedTrackIndex ? trackIndex : selectedTrackIndex;
 
-        for (int i = lowerBound; i <= upperBound; ++i)
         {
-            MediaTrack *currentTrack = context->GetPage()->GetTrackFromId(i);
-            
-            if (currentTrack == NULL)
-                continue;
+            DAWUIRefreshBatch refreshBatch;
             
-            if (context->GetPage()->GetIsTrackVisible(currentTrack))
-                CSurf_SetSurfaceSelected(currentTrack, CSurf_OnSelectedChange(currentTrack, 1), NULL);
+            for (int i = lowerBound; i <= upperBound; ++i)
+            {
+                MediaTrack *currentTrack = context->GetPage()->GetTrackFromId(i);
+                
+                if (currentTrack == NULL)
+                    continue;
+                
+                if (context->GetPage()->GetIsTrackVisible(currentTrack))
+                    CSurf_SetSurfaceSelected(currentTrack, CSurf_OnSelectedChange(currentTrack, 1), NULL);
+            }
         }
         
         MediaTrack *lowestTrack = context->GetPage()->GetTrackFromId(lowerBound);
@@ -2229,6 +2214,7 @@ class FXNameDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "FXNameDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_OnStructureChange; }
     
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2245,6 +2231,7 @@ class FXMenuNameDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "FXMenuNameDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_OnStructureChange; }
     
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2835,6 +2822,7 @@ class TrackNameDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackNameDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_OnStructureChange; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2857,6 +2845,7 @@ class TrackNumberDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "TrackNumberDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_OnStructureChange; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -2962,7 +2951,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
 
             char trackVolume[128];
             snprintf(trackVolume, sizeof(trackVolume), "%7.2lf", VAL2DB(vol));
@@ -2985,7 +2974,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
 
             char tmp[MEDBUF];
             context->UpdateWidgetValue(context->GetPanValueString(pan, "", tmp, sizeof(tmp)));
@@ -3078,7 +3067,7 @@ public:
             else
             {
                 double vol, pan = 0.0;
-                GetTrackUIVolPan(track, &vol, &pan);
+                context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
                 context->UpdateWidgetValue(context->GetPanValueString(pan, "", tmp, sizeof(tmp)));
             }
         }
@@ -3386,6 +3375,8 @@ public:
     {
         if (value == ActionContext::BUTTON_RELEASE_MESSAGE_VALUE) return;
         
+        DAWWriteTransaction transaction("CSI: Clear all solo");
+        
         SoloAllTracks(0);
     }
 };
@@ -3453,6 +3444,8 @@ public:
         
         int mode = context->GetIntParam();
         
+        DAWWriteTransaction transaction("CSI: Set selected tracks automation mode");
+        
         const vector<MediaTrack *> &selectedTracks = context->GetPage()->GetSelectedTracks();
         for (auto selectedTrack : selectedTracks)
             GetSetMediaTrackInfo(selectedTrack, "I_AUTOMODE", &mode);
@@ -3630,6 +3623,7 @@ class MCUTimeDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "MCUTimeDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_Capped; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -3643,6 +3637,7 @@ class OSCTimeDisplay : public Action
 {
 public:
     virtual const char *GetName() override { return "OSCTimeDisplay"; }
+    virtual UpdateClass GetUpdateClass() override { return UpdateClass_Capped; }
 
     virtual void RequestUpdate(ActionContext *context) override
     {
@@ -3726,10 +3721,10 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {           
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            if (context->GetPage()->GetTrackStateSnapshot().GetIsSoloedOut(track))
                 context->ClearWidget();
             else
-                context->UpdateWidgetValue(volToNormalized(Track_GetPeakInfo(track, context->GetIntParam())));
+                context->UpdateWidgetValue(volToNormalized(context->GetPage()->GetTrackStateSnapshot().GetPeak(track, context->GetIntParam())));
         }
         else
             context->ClearWidget();
@@ -3747,9 +3742,10 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {
-            double lrVol = (Track_GetPeakInfo(track, 0) + Track_GetPeakInfo(track, 1)) / 2.0;
+            TrackStateSnapshot &trackState = context->GetPage()->GetTrackStateSnapshot();
+            double lrVol = (trackState.GetPeak(track, 0) + trackState.GetPeak(track, 1)) / 2.0;
             
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            if (trackState.GetIsSoloedOut(track))
                 context->ClearWidget();
             else
                 context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3771,7 +3767,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
             return volToNormalized(vol);
         }
         else
@@ -3793,9 +3789,10 @@ public:
         {
             if (MediaTrack *track = context->GetTrack())
             {
-                double lrVol = (Track_GetPeakInfo(track, 0) + Track_GetPeakInfo(track, 1)) / 2.0;
+                TrackStateSnapshot &trackState = context->GetPage()->GetTrackStateSnapshot();
+                double lrVol = (trackState.GetPeak(track, 0) + trackState.GetPeak(track, 1)) / 2.0;
                 
-                if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+                if (trackState.GetIsSoloedOut(track))
                     context->ClearWidget();
                 else
                     context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3830,12 +3827,13 @@ public:
     {
         if (MediaTrack *track = context->GetTrack())
         {
-            double lVol = Track_GetPeakInfo(track, 0);
-            double rVol = Track_GetPeakInfo(track, 1);
+            TrackStateSnapshot &trackState = context->GetPage()->GetTrackStateSnapshot();
+            double lVol = trackState.GetPeak(track, 0);
+            double rVol = trackState.GetPeak(track, 1);
             
             double lrVol =  lVol > rVol ? lVol : rVol;
             
-            if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+            if (trackState.GetIsSoloedOut(track))
                 context->ClearWidget();
             else
                 context->UpdateWidgetValue(volToNormalized(lrVol));
@@ -3857,7 +3855,7 @@ public:
         if (MediaTrack *track = context->GetTrack())
         {
             double vol, pan = 0.0;
-            GetTrackUIVolPan(track, &vol, &pan);
+            context->GetPage()->GetTrackStateSnapshot().GetVolPan(track, &vol, &pan);
             return volToNormalized(vol);
         }
         else
@@ -3879,12 +3877,13 @@ public:
         {
             if (MediaTrack *track = context->GetTrack())
             {
-                double lVol = Track_GetPeakInfo(track, 0);
-                double rVol = Track_GetPeakInfo(track, 1);
+                TrackStateSnapshot &trackState = context->GetPage()->GetTrackStateSnapshot();
+                double lVol = trackState.GetPeak(track, 0);
+                double rVol = trackState.GetPeak(track, 1);
                 
                 double lrVol =  lVol > rVol ? lVol : rVol;
                 
-                if (AnyTrackSolo(NULL) && ! GetMediaTrackInfo_Value(track, "I_SOLO"))
+                if (trackState.GetIsSoloedOut(track))
                     context->ClearWidget();
                 else
                     context->UpdateWidgetValue(volToNormalized(lrVol));
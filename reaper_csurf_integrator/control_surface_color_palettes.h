@@ -0,0 +1,363 @@
+//
+//  control_surface_color_palettes.h
+//  reaper_csurf_integrator
+//
+//  Turns the 24 bit colors CSI works in into what each surface can show. The conversions are worked out into
+//  tables once and shared by every feedback processor that talks to that kind of hardware, so updating a color
+//  is a lookup rather than a search or an HSV conversion.
+//
+//  Include after rgba_color.
+//
+
+#ifndef control_surface_color_palettes_h
+#define control_surface_color_palettes_h
+
+#include <algorithm>
+#include <cstdint>
+
+// MIDI Fighter Twister hues, stored in Blue Green Red format
+static const unsigned char s_colorMap7[128][3] = { {0, 0, 0},    // 0
+    {255, 0, 0},    // 1 - Blue
+    {255, 21, 0},    // 2 - Blue (Green Rising)
+    {255, 34, 0},
+    {255, 46, 0},
+    {255, 59, 0},
+    {255, 68, 0},
+    {255, 80, 0},
+    {255, 93, 0},
+    {255, 106, 0},
+    {255, 119, 0},
+    {255, 127, 0},
+    {255, 140, 0},
+    {255, 153, 0},
+    {255, 165, 0},
+    {255, 178, 0},
+    {255, 191, 0},
+    {255, 199, 0},
+    {255, 212, 0},
+    {255, 225, 0},
+    {255, 238, 0},
+    {255, 250, 0},    // 21 - End of Blue's Reign
+    
+    {250, 255, 0}, // 22 - Green (Blue Fading)
+    {237, 255, 0},
+    {225, 255, 0},
+    {212, 255, 0},
+    {199, 255, 0},
+    {191, 255, 0},
+    {178, 255, 0},
+    {165, 255, 0},
+    {153, 255, 0},
+    {140, 255, 0},
+    {127, 255, 0},
+    {119, 255, 0},
+    {106, 255, 0},
+    {93, 255, 0},
+    {80, 255, 0},
+    {67, 255, 0},
+    {59, 255, 0},
+    {46, 255, 0},
+    {33, 255, 0},
+    {21, 255, 0},
+    {8, 255, 0},
+    {0, 255, 0},    // 43 - Green
+    
+    {0, 255, 12},    // 44 - Green/ Red Rising
+    {0, 255, 25},
+    {0, 255, 38},
+    {0, 255, 51},
+    {0, 255, 63},
+    {0, 255, 72},
+    {0, 255, 84},
+    {0, 255, 97},
+    {0, 255, 110},
+    {0, 255, 123},
+    {0, 255, 131},
+    {0, 255, 144},
+    {0, 255, 157},
+    {0, 255, 170},
+    {0, 255, 182},
+    {0, 255, 191},
+    {0, 255, 203},
+    {0, 255, 216},
+    {0, 255, 229},
+    {0, 255, 242},
+    {0, 255, 255},    // 64 - Green + Red (Yellow)
+    
+    {0, 246, 255},    // 65 - Red, Green Fading
+    {0, 233, 255},
+    {0, 220, 255},
+    {0, 208, 255},
+    {0, 195, 255},
+    {0, 187, 255},
+    {0, 174, 255},
+    {0, 161, 255},
+    {0, 148, 255},
+    {0, 135, 255},
+    {0, 127, 255},
+    {0, 114, 255},
+    {0, 102, 255},
+    {0, 89, 255},
+    {0, 76, 255},
+    {0, 63, 255},
+    {0, 55, 255},
+    {0, 42, 255},
+    {0, 29, 255},
+    {0, 16, 255},
+    {0, 4, 255},    // 85 - End Red/Green Fading
+    
+    {4, 0, 255},    // 86 - Red/ Blue Rising
+    {16, 0, 255},
+    {29, 0, 255},
+    {42, 0, 255},
+    {55, 0, 255},
+    {63, 0, 255},
+    {76, 0, 255},
+    {89, 0, 255},
+    {102, 0, 255},
+    {114, 0, 255},
+    {127, 0, 255},
+    {135, 0, 255},
+    {148, 0, 255},
+    {161, 0, 255},
+    {174, 0, 255},
+    {186, 0, 255},
+    {195, 0, 255},
+    {208, 0, 255},
+    {221, 0, 255},
+    {233, 0, 255},
+    {246, 0, 255},
+    {255, 0, 255},    // 107 - Blue + Red
+    
+    {255, 0, 242},    // 108 - Blue/ Red Fading
+    {255, 0, 229},
+    {255, 0, 216},
+    {255, 0, 204},
+    {255, 0, 191},
+    {255, 0, 182},
+    {255, 0, 169},
+    {255, 0, 157},
+    {255, 0, 144},
+    {255, 0, 131},
+    {255, 0, 123},
+    {255, 0, 110},
+    {255, 0, 97},
+    {255, 0, 85},
+    {255, 0, 72},
+    {255, 0, 63},
+    {255, 0, 50},
+    {255, 0, 38},
+    {255, 0, 25},    // 126 - Blue-ish
+    {225, 240, 240}    // 127 - White ?
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ColorPalettes
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+public:
+    // the 8 colors of the X-Touch scribble strips and the X32, numbered the way both devices number them
+    enum ScribbleStripColor
+    {
+        ScribbleStrip_Off = 0,
+        ScribbleStrip_Red,
+        ScribbleStrip_Green,
+        ScribbleStrip_Yellow,
+        ScribbleStrip_Blue,
+        ScribbleStrip_Magenta,
+        ScribbleStrip_Cyan,
+        ScribbleStrip_White
+    };
+
+private:
+    // The MFT hues run round the color wheel in six ramps, each with two channels pinned and the third moving.
+    // A ramp's table gives the hue index for every value of the moving channel.
+    struct MFTRamp
+    {
+        int channel;    // into s_colorMap7, 0 = blue, 1 = green, 2 = red
+        bool isRising;
+        int first;
+        int last;
+    };
+    
+    struct Tables
+    {
+        unsigned char mftHues[6][256];
+        unsigned char v1mBlue[128][128]; // [green][blue], 7 bit
+        
+        Tables()
+        {
+            static const MFTRamp ramps[6] =
+            {
+                { 1, true,    1,  22 },
+                { 0, false,  22,  44 },
+                { 2, true,   44,  65 },
+                { 1, false,  65,  86 },
+                { 0, true,   86, 108 },
+                { 2, false, 108, 127 },
+            };
+            
+            for (int ramp = 0; ramp < 6; ++ramp)
+            {
+                const MFTRamp &mftRamp = ramps[ramp];
+                
+                for (int value = 0; value < 256; ++value)
+                {
+                    mftHues[ramp][value] = 0;
+                    
+                    for (int i = mftRamp.first; i < mftRamp.last; ++i)
+                    {
+                        int previous = s_colorMap7[i - 1][mftRamp.channel];
+                        int current = s_colorMap7[i][mftRamp.channel];
+                        
+                        if (mftRamp.isRising ? (value > previous && value <= current) : (value < previous && value >= current))
+                        {
+                            mftHues[ramp][value] = (unsigned char)i;
+                            break;
+                        }
+                    }
+                }
+            }
+            
+            // blue reads too strong on the V1-M unless there's green with it, b = b * (0.70 + (0.30 * (g / 127)))
+            for (int g = 0; g < 128; ++g)
+                for (int b = 0; b < 128; ++b)
+                    v1mBlue[g][b] = (unsigned char)(static_cast<int>(b * (0.70f + (0.30f * g / 127.0f))) & 0x7F);
+        }
+    };
+    
+    static const Tables &GetTables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+    
+    static int CalculateScribbleStripColor(int r, int g, int b)
+    {
+        // Doing a RGB to HSV conversion since HSV is better for light
+        // Converting RGB to floats between 0 and 1.0 (percentage)
+        float rf = (float) r / 255.0f;
+        float gf = (float) g / 255.0f;
+        float bf = (float) b / 255.0f;
+
+        // Hue will be between 0 and 360 to represent the color wheel.
+        // Saturation and Value are a percentage (between 0 and 1.0)
+        float h, s, v, colorMin, delta;
+        v = max(max(rf, gf), bf);
+
+        // If value is less than this percentage, LCD should be off.
+        if (v <= 0.10)
+            return ScribbleStrip_White; // This could be OFF, but that would show nothing.
+
+        colorMin = min(min(rf, gf), bf);
+        delta = v - colorMin;
+        // Don't need divide by zero check since if value is 0 it will return above.
+        s = delta / v;
+
+        // If saturation is less than this percentage, LCD should be white.
+        if (s <= 0.10)
+            return ScribbleStrip_White;
+
+        // Now we have a valid color. Figure out the hue and return the closest scribble strip value.
+        if (rf >= v)
+            h = (gf - bf) / delta;
+        else if (gf >= v)
+            h = ((bf - rf) / delta) + 2.0f;
+        else
+            h = ((rf - gf) / delta) + 4.0f;
+
+        h *= 60.0;
+        if (h < 0)
+            h += 360.0;
+
+        // The numbers represent the hue from 0-360.
+        if (h >= 330 || h < 20)
+            return ScribbleStrip_Red;
+        if (h >= 250)
+            return ScribbleStrip_Magenta;
+        if (h >= 210)
+            return ScribbleStrip_Blue;
+        if (h >= 160)
+            return ScribbleStrip_Cyan;
+        if (h >= 80)
+            return ScribbleStrip_Green;
+        if (h >= 20)
+            return ScribbleStrip_Yellow;
+
+        return ScribbleStrip_White; // failsafe
+    }
+    
+    static bool GetIsByte(int value) { return value >= 0 && value < 256; }
+
+public:
+    // A table of all 2^24 colors would be 16 MB, so this one fills as colors are asked for. A project only has
+    // a handful of track colors, after the first update each is a single probe.
+    static int GetScribbleStripColor(int r, int g, int b)
+    {
+        static const int NumSlots = 1024;
+        static uint32_t keys[NumSlots]; // rgb + 1, 0 is an empty slot
+        static unsigned char colors[NumSlots];
+        
+        if ( ! GetIsByte(r) || ! GetIsByte(g) || ! GetIsByte(b))
+            return CalculateScribbleStripColor(r, g, b);
+        
+        uint32_t rgb = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+        uint32_t slot = (rgb * 2654435761u) >> 22;
+        
+        if (keys[slot] != rgb + 1)
+        {
+            colors[slot] = (unsigned char)CalculateScribbleStripColor(r, g, b);
+            keys[slot] = rgb + 1;
+        }
+        
+        return colors[slot];
+    }
+    
+    // index into s_colorMap7, only the fully saturated hues map, anything else is 0
+    static int GetMFTColor(int r, int g, int b)
+    {
+        const Tables &tables = GetTables();
+        
+        if (b == 0 && g == 0 && r == 0)
+            return 0;
+        else if (b > 224 && g > 239 && r > 239)
+            return 127;
+        else if (b == 255 && r == 0)
+            return GetIsByte(g) ? tables.mftHues[0][g] : 0;
+        else if (g == 255 && r == 0)
+            return GetIsByte(b) ? tables.mftHues[1][b] : 0;
+        else if (b == 0 && g == 255)
+            return GetIsByte(r) ? tables.mftHues[2][r] : 0;
+        else if (b == 0 && r == 255)
+            return GetIsByte(g) ? tables.mftHues[3][g] : 0;
+        else if (g == 0 && r == 255)
+            return GetIsByte(b) ? tables.mftHues[4][b] : 0;
+        else if (b == 255 && g == 0)
+            return GetIsByte(r) ? tables.mftHues[5][r] : 0;
+        
+        return 0;
+    }
+    
+    // Launchpad, FaderPort and Asparion, only 7 bits fit in a MIDI data byte
+    static rgba_color Get7BitColor(const rgba_color &color)
+    {
+        rgba_color c;
+        c.r = color.r / 2;
+        c.g = color.g / 2;
+        c.b = color.b / 2;
+        c.a = color.a;
+        return c;
+    }
+    
+    static rgba_color GetV1MColor(const rgba_color &color)
+    {
+        rgba_color c;
+        c.r = (color.r >> 1) & 0x7F;
+        c.g = (color.g >> 1) & 0x7F;
+        c.b = GetTables().v1mBlue[c.g][(color.b >> 1) & 0x7F];
+        c.a = color.a;
+        return c;
+    }
+};
+
+#endif /* control_surface_color_palettes_h */
@@ -29,9 +29,12 @@ int g_debugLevel = DEBUG_LEVEL_ERROR;
 bool g_surfaceRawInDisplay;
 bool g_surfaceInDisplay;
 bool g_surfaceOutDisplay;
+bool g_surfaceLatencyDisplay;
 
 bool g_fxParamsWrite;
 
+TraceRing g_traceRing;
+
 void GetPropertiesFromTokens(int start, int finish, const vector<string> &tokens, PropertyList &properties)
 {
     for (int i = start; i < finish; ++i)
@@ -251,6 +254,88 @@ int strToHex(string &valueStr)
     return strtol(valueStr.c_str(), NULL, 16);
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Symbols
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Only ever grows, so a symbol stays valid across reloads. A deque so the names don't move, zones and widgets
+// hand out GetSymbolName's pointer as their name. Main thread only, like the template loading that interns,
+// nothing here is locked.
+static deque<string> s_symbolNames;
+static map<const string, int> s_symbolsByName;
+
+static void InitSymbols()
+{
+    if (s_symbolNames.size() > 0)
+        return;
+
+    s_symbolNames.push_back("");
+
+#define ADDSYM(x) s_symbolsByName[#x] = (int)s_symbolNames.size(); s_symbolNames.push_back(#x);
+    DECLARE_CSI_SYMBOLS(ADDSYM)
+#undef ADDSYM
+
+    WDL_ASSERT(s_symbolNames.size() == CSISymbol_NumPredefined);
+}
+
+int InternSymbol(const char *name)
+{
+    InitSymbols();
+
+    auto it = s_symbolsByName.find(name);
+    if (it != s_symbolsByName.end())
+        return it->second;
+
+    int symbol = (int)s_symbolNames.size();
+    s_symbolNames.push_back(name);
+    s_symbolsByName[name] = symbol;
+
+    return symbol;
+}
+
+int FindSymbol(const char *name)
+{
+    InitSymbols();
+
+    auto it = s_symbolsByName.find(name);
+    if (it != s_symbolsByName.end())
+        return it->second;
+
+    return CSISymbol_None;
+}
+
+const char *GetSymbolName(int symbol)
+{
+    if (symbol > 0 && symbol < (int)s_symbolNames.size())
+        return s_symbolNames[symbol].c_str();
+
+    return "";
+}
+
+int GetNumSymbols()
+{
+    InitSymbols();
+
+    return (int)s_symbolNames.size();
+}
+
+void SaveTrace()
+{
+    string tracePath = string(GetResourcePath()) + "/CSI/CSI.trace";
+
+    FILE *traceFile = fopenUTF8(tracePath.c_str(), "wb");
+
+    if (traceFile == NULL)
+    {
+        LogToConsole(256, "[ERROR] FAILED to SaveTrace, cannot write %s\n", tracePath.c_str());
+        return;
+    }
+
+    int numEvents = g_traceRing.Dump(traceFile, GetNumSymbols(), GetSymbolName);
+    fclose(traceFile);
+
+    LogToConsole(MEDBUF, "Saved %d trace events to %s\n", numEvents, tracePath.c_str());
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 struct MidiPort
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -532,12 +617,12 @@ void Midi_ControlSurface::ProcessMidiWidget(int &lineNumber, ifstream &surfaceTe
             CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<Fader7Bit_Midi_CSIMessageGenerator>(csi_, widget)));
         else if (widgetType == "Encoder" && widgetClass == "RotaryWidgetClass")
             CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator>(csi_, widget)));
-        else if (widgetType == "Encoder" && size == 4)
-            CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<Encoder_Midi_CSIMessageGenerator>(csi_, widget)));
+        else if (widgetType == "Encoder" && (size == 4 || (size == 5 && tokenLines[i][4] == "TimeAccelerated")))
+            CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<Encoder_Midi_CSIMessageGenerator>(csi_, widget, size == 5)));
         else if (widgetType == "MFTEncoder" && size > 4)
             CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<MFT_AcceleratedEncoder_Midi_CSIMessageGenerator>(csi_, widget, tokenLines[i])));
-        else if (widgetType == "EncoderPlain" && size == 4)
-            CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<EncoderPlain_Midi_CSIMessageGenerator>(csi_, widget)));
+        else if (widgetType == "EncoderPlain" && (size == 4 || (size == 5 && tokenLines[i][4] == "TimeAccelerated")))
+            CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<EncoderPlain_Midi_CSIMessageGenerator>(csi_, widget, size == 5)));
         else if (widgetType == "Encoder7Bit" && size == 4)
             CSIMessageGeneratorsByMessage_.insert(make_pair(twoByteKey, make_unique<Encoder7Bit_Midi_CSIMessageGenerator>(csi_, widget)));
         else if (widgetType == "Touch" && size == 7)
@@ -842,15 +927,15 @@ void OSC_ControlSurface::ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemp
     for (int i = 0; i < (int)tokenLines.size(); ++i)
     {
         if (tokenLines[i].size() > 1 && tokenLines[i][0] == "Control")
-            CSIMessageGeneratorsByMessage_.insert(make_pair(tokenLines[i][1], make_unique<CSIMessageGenerator>(csi_, widget)));
+            AddOSCMessageGenerator(tokenLines[i][1], make_unique<Control_OSC_MessageGenerator>(csi_, widget));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "AnyPress")
-            CSIMessageGeneratorsByMessage_.insert(make_pair(tokenLines[i][1], make_unique<AnyPress_CSIMessageGenerator>(csi_, widget)));
+            AddOSCMessageGenerator(tokenLines[i][1], make_unique<AnyPress_CSIMessageGenerator>(csi_, widget));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "Touch")
-            CSIMessageGeneratorsByMessage_.insert(make_pair(tokenLines[i][1], make_unique<Touch_CSIMessageGenerator>(csi_, widget)));
+            AddOSCMessageGenerator(tokenLines[i][1], make_unique<Touch_CSIMessageGenerator>(csi_, widget));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "X32Fader")
-            CSIMessageGeneratorsByMessage_.insert(make_pair(tokenLines[i][1], make_unique<X32_Fader_OSC_MessageGenerator>(csi_, widget)));
+            AddOSCMessageGenerator(tokenLines[i][1], make_unique<X32_Fader_OSC_MessageGenerator>(csi_, widget));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "X32RotaryToEncoder")
-            CSIMessageGeneratorsByMessage_.insert(make_pair(tokenLines[i][1], make_unique<X32_RotaryToEncoder_OSC_MessageGenerator>(csi_, widget)));
+            AddOSCMessageGenerator(tokenLines[i][1], make_unique<X32_RotaryToEncoder_OSC_MessageGenerator>(csi_, widget));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_Processor")
             widget->GetFeedbackProcessors().push_back(make_unique<OSC_FeedbackProcessor>(csi_, this, widget, tokenLines[i][1]));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_IntProcessor")
@@ -863,6 +948,11 @@ void OSC_ControlSurface::ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemp
             widget->GetFeedbackProcessors().push_back(make_unique<OSC_X32FaderFeedbackProcessor>(csi_, this, widget, tokenLines[i][1]));
         else if (tokenLines[i].size() > 1 && tokenLines[i][0] == "FB_X32RotaryToEncoder")
             widget->GetFeedbackProcessors().push_back(make_unique<OSC_X32_RotaryToEncoderFeedbackProcessor>(csi_, this, widget, tokenLines[i][1]));
+        else
+            continue;
+        
+        if (tokenLines[i].size() > 2 && tokenLines[i][0].find("FB_") == 0)
+            static_cast<OSC_FeedbackProcessor *>(widget->GetFeedbackProcessors().back().get())->SetResolution(tokenLines[i][2].c_str());
     }
 }
 
@@ -873,6 +963,7 @@ void ControlSurface::ProcessValues(const vector<vector<string>> &lines)
 {
     bool inStepSizes = false;
     bool inAccelerationValues = false;
+    bool inMotorFaderFeedback = false;
         
     for (int i = 0; i < (int)lines.size(); ++i)
     {
@@ -898,6 +989,16 @@ void ControlSurface::ProcessValues(const vector<vector<string>> &lines)
                 inAccelerationValues = false;
                 continue;
             }
+            else if (lines[i][0] == "MotorFaderFeedback")
+            {
+                inMotorFaderFeedback = true;
+                continue;
+            }
+            else if (lines[i][0] == "MotorFaderFeedbackEnd")
+            {
+                inMotorFaderFeedback = false;
+                continue;
+            }
 
             if (lines[i].size() > 1)
             {
@@ -905,6 +1006,13 @@ void ControlSurface::ProcessValues(const vector<vector<string>> &lines)
                 
                 if (inStepSizes)
                     stepSize_[widgetClass] = atof(lines[i][1].c_str());
+                else if (inMotorFaderFeedback)
+                {
+                    if (widgetClass == "MinInterval")
+                        motorFaderMinInterval_ = max(atoi(lines[i][1].c_str()), 0);
+                    else if (widgetClass == "MinDelta")
+                        motorFaderMinDelta_ = max(atof(lines[i][1].c_str()), 0.0);
+                }
                 else if (lines[i].size() > 2 && inAccelerationValues)
                 {
                     
@@ -935,6 +1043,8 @@ void Midi_ControlSurface::ProcessMIDIWidgetFile(const string &filePath, Midi_Con
     accelerationValuesForDecrement_.clear();
     accelerationValuesForIncrement_.clear();
     accelerationValues_.clear();
+    motorFaderMinInterval_ = 0;
+    motorFaderMinDelta_ = 0.0;
 
     try
     {
@@ -956,8 +1066,11 @@ void Midi_ControlSurface::ProcessMIDIWidgetFile(const string &filePath, Midi_Con
             if (tokens.size() > 0 && tokens[0] != "Widget")
                 valueLines.push_back(tokens);
             
-            if (tokens.size() > 0 && tokens[0] == "AccelerationValuesEnd")
+            if (tokens.size() > 0 && (tokens[0] == "AccelerationValuesEnd" || tokens[0] == "MotorFaderFeedbackEnd"))
+            {
                 ProcessValues(valueLines);
+                valueLines.clear();
+            }
 
             if (tokens.size() > 0 && (tokens[0] == "Widget"))
                 ProcessMidiWidget(lineNumber, file, tokens);
@@ -1193,10 +1306,29 @@ void CSurfIntegrator::InitActionsDictionary()
     actions_.insert(make_pair("TrackReceivePrePostDisplay", make_unique<TrackReceivePrePostDisplay>()));
 }
 
+static string GetFileContents(const string &filePath)
+{
+    ifstream file(filePath, ios::binary);
+    stringstream contents;
+    contents << file.rdbuf();
+    
+    return contents.str();
+}
+
 void CSurfIntegrator::Init()
 {
     pages_.clear();
     
+    // a reset is also how the user recovers a surface that was power cycled, so send everything again
+    for (auto &io : midiSurfacesIO_)
+        io->InvalidateShadow();
+    
+    for (auto &io : oscSurfacesIO_)
+    {
+        io->InvalidateShadow();
+        io->ClearSubscriptions(); // the new surfaces add theirs
+    }
+    
     string currentBroadcaster;
     
     Page *currentPage = NULL;
@@ -1212,6 +1344,8 @@ void CSurfIntegrator::Init()
         return;
     }
     
+    resourceFileWatcher_.Start(CSIFolderPath);
+    
     string iniFilePath = string(GetResourcePath()) + "/CSI/CSI.ini";
     
     if ( ! filesystem::exists(iniFilePath))
@@ -1223,6 +1357,7 @@ void CSurfIntegrator::Init()
         return;
     }
 
+    iniFileContents_ = GetFileContents(iniFilePath);
     
     int lineNumber = 0;
     
@@ -1289,9 +1424,10 @@ void CSurfIntegrator::Init()
                         {
                             int channelCount = atoi(channelCountProp);
                             
-                            if ( ! strcmp(typeProp, s_MidiSurfaceToken) && tokens.size() == 7)
+                            if ( ! strcmp(typeProp, s_MidiSurfaceToken) && (tokens.size() == 7 || tokens.size() == 8))
                             {
-                                if (pList.get_prop(PropertyType_MidiInput) != NULL &&
+                                if ( ! GetHasSurfaceIO(nameProp) &&
+                                    pList.get_prop(PropertyType_MidiInput) != NULL &&
                                     pList.get_prop(PropertyType_MidiOutput) != NULL &&
                                     pList.get_prop(PropertyType_MIDISurfaceRefreshRate) != NULL &&
                                     pList.get_prop(PropertyType_MaxMIDIMesssagesPerRun) != NULL)
@@ -1300,13 +1436,15 @@ void CSurfIntegrator::Init()
                                     int midiOut = atoi(pList.get_prop(PropertyType_MidiOutput));
                                     int surfaceRefreshRate = atoi(pList.get_prop(PropertyType_MIDISurfaceRefreshRate));
                                     int maxMIDIMesssagesPerRun = atoi(pList.get_prop(PropertyType_MaxMIDIMesssagesPerRun));
+                                    int maxMIDIBytesPerSecond = pList.get_prop(PropertyType_MaxMIDIBytesPerSecond) != NULL ? atoi(pList.get_prop(PropertyType_MaxMIDIBytesPerSecond)) : 0;
                                     
-                                    midiSurfacesIO_.push_back(make_unique<Midi_ControlSurfaceIO>(this, nameProp, channelCount, GetMidiInputForPort(midiIn), GetMidiOutputForPort(midiOut), surfaceRefreshRate, maxMIDIMesssagesPerRun));
+                                    midiSurfacesIO_.push_back(make_unique<Midi_ControlSurfaceIO>(this, nameProp, channelCount, GetMidiInputForPort(midiIn), GetMidiOutputForPort(midiOut), surfaceRefreshRate, maxMIDIMesssagesPerRun, maxMIDIBytesPerSecond));
                                 }
                             }
                             else if (( ! strcmp(typeProp, s_OSCSurfaceToken) || ! strcmp(typeProp, s_OSCX32SurfaceToken)) && tokens.size() == 7)
                             {
-                                if (pList.get_prop(PropertyType_ReceiveOnPort) != NULL &&
+                                if ( ! GetHasSurfaceIO(nameProp) &&
+                                    pList.get_prop(PropertyType_ReceiveOnPort) != NULL &&
                                     pList.get_prop(PropertyType_TransmitToPort) != NULL &&
                                     pList.get_prop(PropertyType_TransmitToIPAddress) != NULL &&
                                     pList.get_prop(PropertyType_MaxPacketsPerRun) != NULL)
@@ -1515,6 +1653,51 @@ void CSurfIntegrator::Init()
     }
 }
 
+void CSurfIntegrator::ReloadChangedFiles()
+{
+    set<string> changedFiles;
+    resourceFileWatcher_.GetChangedFiles(changedFiles);
+    
+    if (changedFiles.empty())
+        return;
+    
+    filesystem::path iniFilePath = filesystem::path(string(GetResourcePath()) + "/CSI/CSI.ini").lexically_normal();
+    
+    bool isIniFileChanged = false;
+    bool isSurfaceFileChanged = false;
+    
+    for (const string &changedFile : changedFiles)
+    {
+        if (changedFile == iniFilePath.string())
+            isIniFileChanged = GetFileContents(changedFile) != iniFileContents_;
+        else if (filesystem::path(changedFile).filename() == "Surface.txt")
+            isSurfaceFileChanged = true;
+    }
+    
+    if (isIniFileChanged)
+    {
+        if (g_debugLevel >= DEBUG_LEVEL_NOTICE) LogToConsole(256, "[NOTICE] RELOADING: CSI.ini changed\n");
+        
+        // surfaces may have been added, removed or moved to other ports, so this one starts over
+        pages_.clear();
+        midiSurfacesIO_.clear();
+        oscSurfacesIO_.clear();
+        Init();
+    }
+    else if (isSurfaceFileChanged)
+    {
+        if (g_debugLevel >= DEBUG_LEVEL_NOTICE) LogToConsole(256, "[NOTICE] RELOADING: a Surface.txt changed\n");
+        
+        Init(); // the pages and surfaces are rebuilt on the surface IO that is already open
+    }
+    else
+    {
+        for (const string &changedFile : changedFiles)
+            for (auto &page : pages_)
+                page->ReloadZoneFile(changedFile);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // TrackNavigator
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1730,10 +1913,45 @@ const char *ActionContext::GetName()
     return zone_->GetAlias();
 }
 
+bool ActionContext::GetIsUpdateDue()
+{
+    const UpdateClass updateClass = action_->GetUpdateClass();
+    
+    if (updateClass == UpdateClass_EveryTick)
+        return true;
+    
+    const DWORD now = GetTickCount();
+    
+    // someone else wrote to the widget (another zone or modifier, a page enter clear), so what it shows isn't ours
+    bool isDue = updateStructureGeneration_ < 0 || widget_->GetWriteCount() != updateWidgetWriteCount_;
+    
+    if (updateClass == UpdateClass_Capped)
+        isDue = isDue || now - lastUpdateTs_ >= CappedUpdateIntervalMs;
+    else
+        isDue = isDue ||
+                updateStructureGeneration_ != csi_->GetStructureGeneration() ||
+                updateTrack_ != GetTrack() ||
+                updateSlotIndex_ != GetSlotIndex() ||
+                now - lastUpdateTs_ >= StructureUpdateIntervalMs;
+    
+    return isDue;
+}
+
 void ActionContext::RequestUpdate()
 {
-    if (provideFeedback_)
-        action_->RequestUpdate(this);
+    if ( ! provideFeedback_ || ! GetIsUpdateDue())
+        return;
+    
+    action_->RequestUpdate(this);
+    
+    if (action_->GetUpdateClass() != UpdateClass_EveryTick)
+    {
+        updateStructureGeneration_ = csi_->GetStructureGeneration();
+        updateWidgetWriteCount_ = widget_->GetWriteCount();
+        updateTrack_ = GetTrack();
+        updateSlotIndex_ = GetSlotIndex();
+        lastUpdateTs_ = GetTickCount();
+    }
 }
 
 void ActionContext::ClearWidget()
@@ -1777,7 +1995,7 @@ void ActionContext::UpdateTrackColor()
 {
     if (MediaTrack* track = zone_->GetNavigator()->GetTrack())
     {
-        rgba_color color = DAW::GetTrackColor(track);
+        rgba_color color = GetPage()->GetTrackStateSnapshot().GetColor(track);
         widget_->UpdateColorValue(color);
     }
 }
@@ -1944,6 +2162,8 @@ void ActionContext::DoRangeBoundAction(double value)
     if (isValueInverted_)
         value = 1.0 - value;
     
+    g_traceRing.Record(TraceEvent_Action, GetSurface()->GetSymbol(), action_->GetSymbol(), value);
+    
         action_->Do(this, value);
 }
 
@@ -2155,38 +2375,34 @@ void Zone::InitSubZones(const vector<string> &subZones, const char *widgetSuffix
 
 int Zone::GetSlotIndex()
 {
-    if (name_ == "TrackSend")
-        return zoneManager_->GetTrackSendOffset();
-    if (name_ == "TrackReceive")
-        return zoneManager_->GetTrackReceiveOffset();
-    if (name_ == "TrackFXMenu")
-        return zoneManager_->GetTrackFXMenuOffset();
-    if (name_ == "SelectedTrack")
-        return slotIndex_;
-    if (name_ == "SelectedTrackSend")
-        return slotIndex_ + zoneManager_->GetSelectedTrackSendOffset();
-    if (name_ == "SelectedTrackReceive")
-        return slotIndex_ + zoneManager_->GetSelectedTrackReceiveOffset();
-    if (name_ == "SelectedTrackFXMenu")
-        return slotIndex_ + zoneManager_->GetSelectedTrackFXMenuOffset();
-    if (name_ == "MasterTrackFXMenu")
-        return slotIndex_ + zoneManager_->GetMasterTrackFXMenuOffset();
-    else return slotIndex_;
+    switch (symbol_)
+    {
+        case CSISymbol_TrackSend: return zoneManager_->GetTrackSendOffset();
+        case CSISymbol_TrackReceive: return zoneManager_->GetTrackReceiveOffset();
+        case CSISymbol_TrackFXMenu: return zoneManager_->GetTrackFXMenuOffset();
+        case CSISymbol_SelectedTrackSend: return slotIndex_ + zoneManager_->GetSelectedTrackSendOffset();
+        case CSISymbol_SelectedTrackReceive: return slotIndex_ + zoneManager_->GetSelectedTrackReceiveOffset();
+        case CSISymbol_SelectedTrackFXMenu: return slotIndex_ + zoneManager_->GetSelectedTrackFXMenuOffset();
+        case CSISymbol_MasterTrackFXMenu: return slotIndex_ + zoneManager_->GetMasterTrackFXMenuOffset();
+        default: return slotIndex_;
+    }
 }
 
 void Zone::AddWidget(Widget *widget)
 {
-    if (find(widgets_.begin(), widgets_.end(), widget) == widgets_.end())
+    if (widgetSet_.insert(widget).second)
         widgets_.push_back(widget);
 }
 
 void Zone::Activate()
 {
+    g_traceRing.Record(TraceEvent_ZoneActivated, zoneManager_->GetSurface()->GetSymbol(), symbol_, 0.0);
+    
     UpdateCurrentActionContextModifiers();
     
     for (auto &widget : widgets_)
     {
-        if (!strcmp(widget->GetName(), "OnZoneActivation"))
+        if (widget->GetSymbol() == CSISymbol_OnZoneActivation)
             for (auto &actionContext :  GetActionContexts(widget))
                 actionContext->DoAction(1.0);
         
@@ -2195,14 +2411,14 @@ void Zone::Activate()
 
     isActive_ = true;
     
-    if (!strcmp(GetName(), "VCA"))
+    if (symbol_ == CSISymbol_VCA)
         zoneManager_->GetSurface()->GetPage()->VCAModeActivated();
-    else if (!strcmp(GetName(), "Folder"))
+    else if (symbol_ == CSISymbol_Folder)
         zoneManager_->GetSurface()->GetPage()->FolderModeActivated();
-    else if (!strcmp(GetName(), "SelectedTracks"))
+    else if (symbol_ == CSISymbol_SelectedTracks)
         zoneManager_->GetSurface()->GetPage()->SelectedTracksModeActivated();
 
-    zoneManager_->GetSurface()->SendOSCMessage(GetName());
+    zoneManager_->GetSurface()->SendOSCMessage(GetName(), symbol_);
 
     for (auto &subZone : subZones_)
         subZone->Deactivate();
@@ -2215,6 +2431,9 @@ void Zone::Deactivate()
 {
     if (!isActive_)
         return;
+    
+    g_traceRing.Record(TraceEvent_ZoneDeactivated, zoneManager_->GetSurface()->GetSymbol(), symbol_, 0.0);
+    
     for (auto &widget : widgets_)
     {
         for (auto &actionContext : GetActionContexts(widget))
@@ -2222,18 +2441,18 @@ void Zone::Deactivate()
             actionContext->UpdateWidgetValue(0.0);
             actionContext->UpdateWidgetValue("");
 
-            if (!strcmp(widget->GetName(), "OnZoneDeactivation"))
+            if (widget->GetSymbol() == CSISymbol_OnZoneDeactivation)
                 actionContext->DoAction(1.0);
         }
     }
 
     isActive_ = false;
     
-    if (!strcmp(GetName(), "VCA"))
+    if (symbol_ == CSISymbol_VCA)
         zoneManager_->GetSurface()->GetPage()->VCAModeDeactivated();
-    else if (!strcmp(GetName(), "Folder"))
+    else if (symbol_ == CSISymbol_Folder)
         zoneManager_->GetSurface()->GetPage()->FolderModeDeactivated();
-    else if (!strcmp(GetName(), "SelectedTracks"))
+    else if (symbol_ == CSISymbol_SelectedTracks)
         zoneManager_->GetSurface()->GetPage()->SelectedTracksModeDeactivated();
     
     for (auto &includedZone : includedZones_)
@@ -2243,6 +2462,28 @@ void Zone::Deactivate()
         subZone->Deactivate();
 }
 
+void Zone::RunDeferredActions()
+{
+    if (! isActive_)
+        return;
+    
+    for (auto &subZone : subZones_)
+        subZone->RunDeferredActions();
+
+    for (auto &includedZone : includedZones_)
+        includedZone->RunDeferredActions();
+    
+    // the widgets RequestUpdate will give this zone
+    for (auto widget : widgets_)
+    {
+        if ( ! widget->GetHasBeenUsedByUpdate())
+        {
+            widget->SetHasBeenUsedByUpdate();
+            RunDeferredActionsWidget(widget);
+        }
+    }
+}
+
 void Zone::RequestUpdate()
 {
     if (! isActive_)
@@ -2279,7 +2520,7 @@ void Zone::RestoreXTouchDisplayColors()
 void Zone::OverrideTrackColors(const char* colors)
 {
     for (auto& widget : widgets_)
-        widget->OverrideTrackColors(colors, name_);
+        widget->OverrideTrackColors(colors, GetName());
 }
 
 void Zone::RestoreTrackColors()
@@ -2301,7 +2542,7 @@ void Zone::DoAction(Widget *widget, bool &isUsed, double value)
     if (isUsed)
         return;
 
-    if (find(widgets_.begin(), widgets_.end(), widget) != widgets_.end())
+    if (GetHasWidget(widget))
     {
         isUsed = true;
         
@@ -2326,7 +2567,7 @@ void Zone::DoRelativeAction(Widget *widget, bool &isUsed, double delta)
     if (isUsed)
         return;
 
-    if (find(widgets_.begin(), widgets_.end(), widget) != widgets_.end())
+    if (GetHasWidget(widget))
     {
         isUsed = true;
 
@@ -2351,7 +2592,7 @@ void Zone::DoRelativeAction(Widget *widget, bool &isUsed, int accelerationIndex,
     if (isUsed)
         return;
 
-    if (find(widgets_.begin(), widgets_.end(), widget) != widgets_.end())
+    if (GetHasWidget(widget))
     {
         isUsed = true;
 
@@ -2376,7 +2617,7 @@ void Zone::DoTouch(Widget *widget, const char *widgetName, bool &isUsed, double
     if (isUsed)
         return;
     
-    if (find(widgets_.begin(), widgets_.end(), widget) != widgets_.end())
+    if (GetHasWidget(widget))
     {
         isUsed = true;
 
@@ -2465,24 +2706,32 @@ ZoneManager *Widget::GetZoneManager()
 
 void Widget::Configure(const vector<unique_ptr<ActionContext>> &contexts)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->Configure(contexts);
 }
 
 void  Widget::UpdateValue(const PropertyList &properties, double value)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->SetValue(properties, value);
 }
 
 void  Widget::UpdateValue(const PropertyList &properties, const char * const &value)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->SetValue(properties, value);
 }
 
 void  Widget::ForceValue(const PropertyList &properties, const char * const &value)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->ForceValue(properties, value);
 }
@@ -2493,32 +2742,48 @@ void Widget::RunDeferredActions()
         feedbackProcessor->RunDeferredActions();
 }
 
+void Widget::SendPendingFeedback()
+{
+    for (auto &feedbackProcessor : feedbackProcessors_)
+        feedbackProcessor->SendPendingFeedback();
+}
+
 void  Widget::UpdateColorValue(const rgba_color &color)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->SetColorValue(color);
 }
 
 void Widget::SetXTouchDisplayColors(const char *colors)
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->SetXTouchDisplayColors(colors);
 }
 
 void Widget::RestoreXTouchDisplayColors()
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->RestoreXTouchDisplayColors();
 }
 
 void Widget::OverrideTrackColors(const char* colors, string const zone_name)
 {
+    writeCount_++;
+    
     for (auto& feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->OverrideTrackColors(colors, zone_name);
 }
 
 void Widget::RestoreTrackColors()
 {
+    writeCount_++;
+    
     for (auto& feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->RestoreTrackColors();
 }
@@ -2526,10 +2791,27 @@ void Widget::RestoreTrackColors()
 
 void  Widget::ForceClear()
 {
+    writeCount_++;
+    
     for (auto &feedbackProcessor : feedbackProcessors_)
         feedbackProcessor->ForceClear();
 }
 
+LatencyEcho Widget::TakeLatencyEcho()
+{
+    LatencyEcho echo;
+    
+    if (inputArrivalTime_ != 0.0 && g_surfaceLatencyDisplay)
+    {
+        echo.trace = &surface_->GetLatencyTrace();
+        echo.arrivalTime = inputArrivalTime_;
+    }
+    
+    inputArrivalTime_ = 0.0;
+    
+    return echo;
+}
+
 void Widget::LogInput(double value)
 {
     if (g_surfaceInDisplay) LogToConsole(256, "IN <- %s %s %f\n", GetSurface()->GetName(), GetName(), value);
@@ -2540,7 +2822,7 @@ void Widget::LogInput(double value)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 void Midi_FeedbackProcessor::SendMidiSysExMessage(MIDI_event_ex_t *midiMessage)
 {
-    surface_->SendMidiSysExMessage(midiMessage);
+    surface_->SendMidiSysExMessage(midiMessage, this);
 }
 
 void Midi_FeedbackProcessor::SendMidiMessage(int first, int second, int third)
@@ -2565,7 +2847,7 @@ void Midi_FeedbackProcessor::ForceMidiMessage(int first, int second, int third)
     lastMessageSent_.midi_message[0] = first;
     lastMessageSent_.midi_message[1] = second;
     lastMessageSent_.midi_message[2] = third;
-    surface_->SendMidiMessage(first, second, third);
+    surface_->SendMidiMessage(first, second, third, true, widget_->TakeLatencyEcho());
 }
 
 void Midi_FeedbackProcessor::LogMessage(char* value)
@@ -2575,13 +2857,33 @@ void Midi_FeedbackProcessor::LogMessage(char* value)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // OSC_FeedbackProcessor
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OSC_FeedbackProcessor::SetResolution(const char *resolution)
+{
+    double numerator = 0.0, denominator = 1.0;
+    
+    if (sscanf(resolution, "%lf/%lf", &numerator, &denominator) < 1 || numerator < 0.0 || denominator <= 0.0)
+    {
+        LogToConsole(256, "[ERROR] %s: invalid feedback resolution '%s'\n", GetWidget()->GetName(), resolution);
+        return;
+    }
+    
+    resolution_ = numerator / denominator;
+}
+
 void OSC_FeedbackProcessor::SetColorValue(const rgba_color &color)
 {
     if (lastColor_ != color)
     {
         lastColor_ = color;
+        
+        if (colorAddressSymbol_ == CSISymbol_None)
+        {
+            colorAddress_ = oscAddress_ + "/Color";
+            colorAddressSymbol_ = InternSymbol(colorAddress_.c_str());
+        }
+        
         char tmp[32];
-        surface_->SendOSCMessage(this, (oscAddress_ + "/Color").c_str(), color.rgba_to_string(tmp));
+        surface_->SendOSCMessage(this, colorAddress_.c_str(), colorAddressSymbol_, color.rgba_to_string(tmp));
     }
 }
 
@@ -2591,36 +2893,36 @@ void OSC_FeedbackProcessor::ForceValue(const PropertyList &properties, double va
         return;
 
     lastDoubleValue_ = value;
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), value);
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, value);
 }
 
 void OSC_FeedbackProcessor::ForceValue(const PropertyList &properties, const char * const &value)
 {
     lastStringValue_ = value;
     char tmp[MEDBUF];
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), GetWidget()->GetSurface()->GetRestrictedLengthText(value,tmp,sizeof(tmp)));
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, GetWidget()->GetSurface()->GetRestrictedLengthText(value,tmp,sizeof(tmp)));
 }
 
 void OSC_FeedbackProcessor::ForceClear()
 {
     lastDoubleValue_ = 0.0;
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), 0.0);
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, 0.0);
     
     lastStringValue_ = "";
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), "");
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, "");
 }
 
 void OSC_IntFeedbackProcessor::ForceClear()
 {
     lastDoubleValue_ = 0.0;
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), (int)0);
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, (int)0);
 }
 
 void OSC_IntFeedbackProcessor::ForceValue(const PropertyList &properties, double value)
 {
     lastDoubleValue_ = value;
     
-    surface_->SendOSCMessage(this, oscAddress_.c_str(), (int)value);
+    surface_->SendOSCMessage(this, oscAddress_.c_str(), oscAddressSymbol_, (int)value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2646,6 +2948,13 @@ void ZoneManager::Initialize()
         return;
     }
             
+    LoadHomeAndGoZones();
+        
+    homeZone_->Activate();
+}
+
+void ZoneManager::LoadHomeAndGoZones()
+{
     homeZone_ = make_unique<Zone>(csi_, this, GetSelectedTrackNavigator(), 0, "Home", "Home", zoneInfo_["Home"].filePath);
     LoadZoneFile(homeZone_.get(), "");
     
@@ -2659,8 +2968,108 @@ void ZoneManager::Initialize()
         lastTouchedFXParamZone_ = make_shared<Zone>(csi_, this, GetFocusedFXNavigator(), 0, "LastTouchedFXParam", "LastTouchedFXParam", zoneInfo_["LastTouchedFXParam"].filePath);
         LoadZoneFile(lastTouchedFXParamZone_.get(), "");
     }
+}
+
+static bool GetIsInFolder(const filesystem::path &filePath, const string &folder)
+{
+    if (folder.empty())
+        return false;
+    
+    filesystem::path relativePath = filePath.lexically_relative(filesystem::path(folder).lexically_normal());
+    
+    return ! relativePath.empty() && *relativePath.begin() != "..";
+}
+
+// Called for each .zon file that was written while running. Only the zones that were loaded from the file are
+// rebuilt, the rest of the surface, its widgets and what was last sent to the hardware stay as they are.
+void ZoneManager::ReloadZoneFile(const filesystem::path &filePath)
+{
+    if ( ! GetIsInFolder(filePath, zoneFolder_) && ! GetIsInFolder(filePath, fxZoneFolder_))
+        return;
+    
+    if ( ! filesystem::exists(filePath))
+        return;
+    
+    PreProcessZoneFile(filePath.string()); // picks up new files and a changed alias
+    
+    if (zoneInfo_.find("Home") == zoneInfo_.end())
+        return;
+    
+    bool isHomeOrGoZoneFile = zoneInfo_.find("GoZones") != zoneInfo_.end() && filesystem::path(zoneInfo_["GoZones"].filePath).lexically_normal() == filePath;
+    
+    if (homeZone_ != NULL && homeZone_->GetUsesFile(filePath))
+        isHomeOrGoZoneFile = true;
+    
+    if (lastTouchedFXParamZone_ != NULL && lastTouchedFXParamZone_->GetUsesFile(filePath))
+        isHomeOrGoZoneFile = true;
+    
+    for (auto &goZone : goZones_)
+        if (goZone->GetUsesFile(filePath))
+            isHomeOrGoZoneFile = true;
+    
+    if (isHomeOrGoZoneFile)
+    {
+        if (g_debugLevel >= DEBUG_LEVEL_NOTICE) LogToConsole(256, "[NOTICE] Reloading Home and Go Zones of %s from %s\n", surface_->GetName(), GetRelativePath(filePath.string().c_str()));
         
-    homeZone_->Activate();
+        vector<int> activeGoZoneSymbols;
+        
+        for (auto &goZone : goZones_)
+            if (goZone->GetIsActive())
+                activeGoZoneSymbols.push_back(goZone->GetSymbol());
+        
+        bool isLastTouchedFXParamZoneActive = lastTouchedFXParamZone_ != NULL && lastTouchedFXParamZone_->GetIsActive();
+        
+        // the old zones are not deactivated, that would blank the hardware only to have the new zones light it up again
+        if (homeZone_ != NULL)
+            zonesToBeDeleted_.push_back(move(homeZone_));
+        
+        for (auto &goZone : goZones_)
+            zonesToBeDeleted_.push_back(move(goZone));
+        
+        goZones_.clear();
+        
+        if (lastTouchedFXParamZone_ != NULL)
+            zonesToBeDeleted_.push_back(lastTouchedFXParamZone_);
+        
+        lastTouchedFXParamZone_ = NULL;
+        
+        LoadHomeAndGoZones();
+        
+        homeZone_->Activate();
+        
+        for (auto &goZone : goZones_)
+            if (find(activeGoZoneSymbols.begin(), activeGoZoneSymbols.end(), goZone->GetSymbol()) != activeGoZoneSymbols.end())
+                goZone->Activate();
+        
+        if (isLastTouchedFXParamZoneActive && lastTouchedFXParamZone_ != NULL)
+            lastTouchedFXParamZone_->Activate();
+    }
+    
+    // the FX zones are reloaded the way they were opened, the focused FX zone comes back on the next CheckFocusedFXState
+    if (focusedFXZone_ != NULL && focusedFXZone_->GetUsesFile(filePath))
+        ClearFocusedFX();
+    
+    for (auto &selectedTrackFXZone : selectedTrackFXZones_)
+    {
+        if (selectedTrackFXZone->GetUsesFile(filePath))
+        {
+            ClearSelectedTrackFX();
+            GoSelectedTrackFX();
+            break;
+        }
+    }
+    
+    if (fxSlotZone_ != NULL && fxSlotZone_->GetUsesFile(filePath))
+    {
+        Navigator *navigator = fxSlotZone_->GetNavigator();
+        int fxSlot = fxSlotZone_->GetSlotIndex();
+        MediaTrack *track = navigator != NULL ? navigator->GetTrack() : NULL;
+        
+        ClearFXSlot();
+        
+        if (track != NULL)
+            GoFXSlot(track, navigator, fxSlot);
+    }
 }
 
 void ZoneManager::PreProcessZoneFile(const string &filePath)
@@ -2738,32 +3147,35 @@ void ZoneManager::GetWidgetNameAndModifiers(const string &line, string &baseWidg
 
 void ZoneManager::GetNavigatorsForZone(const char *zoneName, const char *navigatorName, vector<Navigator *> &navigators)
 {
-    if (!strcmp(navigatorName, "MasterTrackNavigator") || !strcmp(zoneName, "MasterTrack"))
+    int zone = InternSymbol(zoneName);
+    int navigator = FindSymbol(navigatorName);
+    
+    if (navigator == CSISymbol_MasterTrackNavigator || zone == CSISymbol_MasterTrack)
         navigators.push_back(GetMasterTrackNavigator());
-    else if (!strcmp(zoneName, "MasterTrackFXMenu"))
+    else if (zone == CSISymbol_MasterTrackFXMenu)
         for (int i = 0; i < GetNumChannels(); ++i)
             navigators.push_back(GetMasterTrackNavigator());
-    else if (!strcmp(navigatorName, "TrackNavigator") ||
-             !strcmp(zoneName, "Track") ||
-             !strcmp(zoneName, "VCA") ||
-             !strcmp(zoneName, "Folder") ||
-             !strcmp(zoneName, "SelectedTracks") ||
-             !strcmp(zoneName, "TrackSend") ||
-             !strcmp(zoneName, "TrackReceive") ||
-             !strcmp(zoneName, "TrackFXMenu"))
+    else if (navigator == CSISymbol_TrackNavigator ||
+             zone == CSISymbol_Track ||
+             zone == CSISymbol_VCA ||
+             zone == CSISymbol_Folder ||
+             zone == CSISymbol_SelectedTracks ||
+             zone == CSISymbol_TrackSend ||
+             zone == CSISymbol_TrackReceive ||
+             zone == CSISymbol_TrackFXMenu)
         for (int i = 0; i < GetNumChannels(); ++i)
         {
             Navigator *channelNavigator = GetSurface()->GetPage()->GetNavigatorForChannel(i + GetSurface()->GetChannelOffset());
             if (channelNavigator)
                 navigators.push_back(channelNavigator);
         }
-    else if (!strcmp(zoneName, "SelectedTrack") ||
-             !strcmp(zoneName, "SelectedTrackSend") ||
-             !strcmp(zoneName, "SelectedTrackReceive") ||
-             !strcmp(zoneName, "SelectedTrackFXMenu"))
+    else if (zone == CSISymbol_SelectedTrack ||
+             zone == CSISymbol_SelectedTrackSend ||
+             zone == CSISymbol_SelectedTrackReceive ||
+             zone == CSISymbol_SelectedTrackFXMenu)
         for (int i = 0; i < GetNumChannels(); ++i)
             navigators.push_back(GetSelectedTrackNavigator());
-    else if (!strcmp(navigatorName, "FocusedFXNavigator"))
+    else if (navigator == CSISymbol_FocusedFXNavigator)
         navigators.push_back(GetFocusedFXNavigator());
     else
         navigators.push_back(GetSelectedTrackNavigator());
@@ -3133,11 +3545,13 @@ void ZoneManager::DoAction(Widget *widget, double value)
     
 void ZoneManager::DoAction(Widget *widget, double value, bool &isUsed)
 {
-    if (surface_->GetModifiers().size() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers()[0]);
-    
     if (learnFocusedFXZone_ != NULL)
+    {
+        if (surface_->GetModifiers().size() > 0)
+            WidgetMoved(this, widget, surface_->GetModifiers()[0]);
+        
         learnFocusedFXZone_->DoAction(widget, isUsed, value);
+    }
     
     if (isUsed)
         return;
@@ -3187,11 +3601,13 @@ void ZoneManager::DoRelativeAction(Widget *widget, double delta)
 
 void ZoneManager::DoRelativeAction(Widget *widget, double delta, bool &isUsed)
 {
-    if (surface_->GetModifiers().size() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers()[0]);
-
     if (learnFocusedFXZone_ != NULL)
+    {
+        if (surface_->GetModifiers().size() > 0)
+            WidgetMoved(this, widget, surface_->GetModifiers()[0]);
+        
         learnFocusedFXZone_->DoRelativeAction(widget, isUsed, delta);
+    }
 
     if (isUsed)
         return;
@@ -3241,11 +3657,13 @@ void ZoneManager::DoRelativeAction(Widget *widget, int accelerationIndex, double
 
 void ZoneManager::DoRelativeAction(Widget *widget, int accelerationIndex, double delta, bool &isUsed)
 {
-    if (surface_->GetModifiers().size() > 0)
-        WidgetMoved(this, widget, surface_->GetModifiers()[0]);
-
     if (learnFocusedFXZone_ != NULL)
+    {
+        if (surface_->GetModifiers().size() > 0)
+            WidgetMoved(this, widget, surface_->GetModifiers()[0]);
+        
         learnFocusedFXZone_->DoRelativeAction(widget, isUsed, accelerationIndex, delta);
+    }
 
     if (isUsed)
         return;
@@ -3413,54 +3831,181 @@ void ModifierManager::SetLatchModifier(bool value, Modifiers modifier, int latch
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-// TrackNavigationManager
+// TrackTopology
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-void TrackNavigationManager::RebuildTracks()
+void TrackTopology::ReadRelations(MediaTrack *track, TrackRelations &relations)
 {
-    int oldTracksSize = (int)tracks_.size();
-
-    tracks_.clear();
-
-    for (int i = 1; i <= GetNumTracks(); ++i)
-    {
-        if (MediaTrack* track = CSurf_TrackFromID(i, followMCP_))
-            if (IsTrackVisible(track, followMCP_))
-                tracks_.push_back(track);
-    }
-
-    if (tracks_.size() < oldTracksSize)
-    {
-        for (int i = oldTracksSize; i > tracks_.size(); i--)
-            page_->ForceClearTrack(i - trackOffset_);
-    }
-
-    page_->UpdateTrackColors();
+    relations.track = track;
+    relations.folderDepth = (int)GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH");
+    relations.leadGroups = (uint64_t)GetSetTrackGroupMembership(track, "VOLUME_VCA_LEAD", 0, 0) | ((uint64_t)GetSetTrackGroupMembershipHigh(track, "VOLUME_VCA_LEAD", 0, 0) << 32);
+    relations.followGroups = (uint64_t)GetSetTrackGroupMembership(track, "VOLUME_VCA_FOLLOW", 0, 0) | ((uint64_t)GetSetTrackGroupMembershipHigh(track, "VOLUME_VCA_FOLLOW", 0, 0) << 32);
 }
 
-void TrackNavigationManager::RebuildSelectedTracks()
+bool TrackTopology::GetHasTrackChanged()
 {
-    if (currentTrackVCAFolderMode_ != 3)
-        return;
-
-    int oldTracksSize = (int) selectedTracks_.size();
+    if (trackRelations_.empty() || GetTickCount() - lastCheckTime_ < CheckInterval)
+        return false;
     
-    selectedTracks_.clear();
+    lastCheckTime_ = GetTickCount();
     
-    for (int i = 0; i < CountSelectedTracks2(NULL, false); ++i)
-        selectedTracks_.push_back(DAW::GetSelectedTrack(i));
-
-    if (selectedTracks_.size() < oldTracksSize)
+    TrackRelations relations;
+    
+    for (int i = 0; i < TracksPerCheck && i < (int)trackRelations_.size(); ++i)
     {
-        for (int i = oldTracksSize; i > selectedTracks_.size(); i--)
-            page_->ForceClearTrack(i - selectedTracksOffset_);
+        nextCheckedTrack_ = (nextCheckedTrack_ + 1) % (int)trackRelations_.size();
+        
+        ReadRelations(trackRelations_[nextCheckedTrack_].track, relations);
+        
+        if ( ! (relations == trackRelations_[nextCheckedTrack_]))
+            return true;
     }
     
-    page_->UpdateTrackColors();
+    return false;
 }
 
-void TrackNavigationManager::AdjustSelectedTrackBank(int amount)
+void TrackTopology::Rebuild(bool followMCP)
 {
-    if (MediaTrack *selectedTrack = GetSelectedTrack())
+    trackRelations_.clear();
+    trackIndices_.clear();
+    folderTopParentTracks_.clear();
+    folderTracks_.clear();
+    vcaTopLeadTracks_.clear();
+    vcaLeadGroups_.clear();
+    
+    for (auto &followerTracks : vcaFollowerTracks_)
+        followerTracks.clear();
+    
+    vector<vector<MediaTrack *> *> currentDepthTracks;
+    
+    for (int i = 1; i <= CSurf_NumTracks(followMCP); ++i)
+    {
+        MediaTrack *track = CSurf_TrackFromID(i, followMCP);
+        
+        if (track == NULL)
+            continue;
+        
+        trackIndices_[track] = i;
+        
+        trackRelations_.emplace_back();
+        TrackRelations &relations = trackRelations_.back();
+        ReadRelations(track, relations);
+        
+        // Folders
+        int folderDepth = relations.folderDepth;
+        
+        if (folderDepth == 1)
+        {
+            if (currentDepthTracks.size() == 0)
+                folderTopParentTracks_.push_back(track);
+            else
+                currentDepthTracks.back()->push_back(track);
+            
+            vector<MediaTrack *> &folderTracks = folderTracks_[track]; // node based, the reference survives later inserts
+            folderTracks.push_back(track);
+            currentDepthTracks.push_back(&folderTracks);
+        }
+        else if (folderDepth == 0 && currentDepthTracks.size() > 0)
+        {
+            currentDepthTracks.back()->push_back(track);
+        }
+        else if (folderDepth < 0 && currentDepthTracks.size() > 0)
+        {
+            currentDepthTracks.back()->push_back(track);
+            
+            for (int j = 0; j < -folderDepth && currentDepthTracks.size() > 0; j++)
+                currentDepthTracks.pop_back();
+        }
+        
+        // VCAs
+        unsigned int leadGroups = (unsigned int)relations.leadGroups;
+        unsigned int leadGroupsHigh = (unsigned int)(relations.leadGroups >> 32);
+        unsigned int followGroups = (unsigned int)relations.followGroups;
+        unsigned int followGroupsHigh = (unsigned int)(relations.followGroups >> 32);
+        
+        if ((leadGroups != 0 && followGroups == 0) || (leadGroupsHigh != 0 && followGroupsHigh == 0))
+            vcaTopLeadTracks_.push_back(track);
+        
+        if (relations.leadGroups != 0)
+            vcaLeadGroups_[track] = relations.leadGroups;
+        
+        uint64_t allFollowGroups = relations.followGroups;
+        
+        for (int group = 0; group < NumVCAGroups && allFollowGroups != 0; ++group)
+            if (allFollowGroups & ((uint64_t)1 << group))
+                vcaFollowerTracks_[group].push_back(track);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TrackNavigationManager
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+int TrackNavigationManager::GetStructureGeneration()
+{
+    return csi_->GetStructureGeneration();
+}
+
+TrackSelection &TrackNavigationManager::GetTrackSelection()
+{
+    return csi_->GetTrackSelection();
+}
+
+TrackStateSnapshot &TrackNavigationManager::GetTrackStateSnapshot()
+{
+    return csi_->GetTrackStateSnapshot();
+}
+
+void TrackNavigationManager::RebuildTracks()
+{
+    int oldTracksSize = (int)tracks_.size();
+
+    tracks_.clear();
+    trackIndices_.clear();
+    tracksGeneration_ = GetStructureGeneration();
+    rebuildCount_++;
+
+    for (int i = 1; i <= GetNumTracks(); ++i)
+    {
+        if (MediaTrack* track = CSurf_TrackFromID(i, followMCP_))
+        {
+            if (IsTrackVisible(track, followMCP_))
+            {
+                trackIndices_[track] = (int)tracks_.size();
+                tracks_.push_back(track);
+            }
+        }
+    }
+
+    if (tracks_.size() < oldTracksSize)
+    {
+        for (int i = oldTracksSize; i > tracks_.size(); i--)
+            page_->ForceClearTrack(i - trackOffset_);
+    }
+
+    page_->UpdateTrackColors();
+}
+
+void TrackNavigationManager::RebuildSelectedTracks()
+{
+    if (currentTrackVCAFolderMode_ != 3)
+        return;
+
+    int oldTracksSize = (int) selectedTracks_.size();
+    
+    selectedTracks_ = GetTrackSelection().GetTracks();
+    selectedTracksGeneration_ = GetStructureGeneration();
+
+    if (selectedTracks_.size() < oldTracksSize)
+    {
+        for (int i = oldTracksSize; i > selectedTracks_.size(); i--)
+            page_->ForceClearTrack(i - selectedTracksOffset_);
+    }
+    
+    page_->UpdateTrackColors();
+}
+
+void TrackNavigationManager::AdjustSelectedTrackBank(int amount)
+{
+    if (MediaTrack *selectedTrack = GetSelectedTrack())
     {
         int trackNum = GetIdFromTrack(selectedTrack);
         
@@ -3486,6 +4031,16 @@ void TrackNavigationManager::AdjustSelectedTrackBank(int amount)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ControlSurface
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ControlSurface::GetShouldParkInput(CSIMessageGenerator *generator, DWORD now)
+{
+    return generator != NULL && generator->GetIsAbsolute() && csi_->GetIsPollingBetweenRuns() && now - generator->GetLastDispatchTime() < FaderDispatchInterval;
+}
+
+bool ControlSurface::GetIsParkedInputDue(CSIMessageGenerator *generator, DWORD now)
+{
+    return ! csi_->GetIsPollingBetweenRuns() || now - generator->GetLastDispatchTime() >= FaderDispatchInterval;
+}
+
 void ControlSurface::Stop()
 {
     if (isRewinding_ || isFastForwarding_) // set the cursor to the Play position
@@ -3512,12 +4067,12 @@ void ControlSurface::Record()
 
 void ControlSurface::OnTrackSelection(MediaTrack *track)
 {
-    string onTrackSelection("OnTrackSelection");
+    auto it = widgetsBySymbol_.find(CSISymbol_OnTrackSelection);
     
-    if (widgetsByName_.count(onTrackSelection) > 0)
+    if (it != widgetsBySymbol_.end())
     {
         if (GetMediaTrackInfo_Value(track, "I_SELECTED"))
-            zoneManager_->DoAction(widgetsByName_[onTrackSelection].get(), 1.0);
+            zoneManager_->DoAction(it->second, 1.0);
         else
             zoneManager_->OnTrackDeselection();
         
@@ -3538,10 +4093,10 @@ void ControlSurface::UpdateTrackColors()
 
     for (int i = 0; i < trackColors_.size(); ++i)
         if (MediaTrack* track = page_->GetNavigatorForChannel(i + channelOffset_)->GetTrack())
-            if (trackColors_[i] != DAW::GetTrackColor(track))
+            if (trackColors_[i] != page_->GetTrackStateSnapshot().GetColor(track))
             {
                 hasChanged = true;
-                rgba_color trackColor = DAW::GetTrackColor(track);
+                rgba_color trackColor = page_->GetTrackStateSnapshot().GetColor(track);
                 trackColors_[i].r = trackColor.r;
                 trackColors_[i].g = trackColor.g;
                 trackColors_[i].b = trackColor.b;
@@ -3564,11 +4119,19 @@ rgba_color ControlSurface::GetTrackColorForChannel(int channel)
         return black;
     
     if (MediaTrack *track = page_->GetNavigatorForChannel(channel + channelOffset_)->GetTrack())
-        return DAW::GetTrackColor(track);
+        return page_->GetTrackStateSnapshot().GetColor(track);
     else
         return black;
 }
 
+void ControlSurface::RunDeferredActions()
+{
+    for (auto widget : widgets_)
+        widget->ClearHasBeenUsedByUpdate();
+
+    zoneManager_->RunDeferredActions();
+}
+
 void ControlSurface::RequestUpdate()
 {
     for (auto widget : widgets_)
@@ -3589,8 +4152,13 @@ void ControlSurface::RequestUpdate()
             widget->UpdateValue(properties, "");
             widget->UpdateColorValue(color);
         }
+        
+        widget->SendPendingFeedback(); // lets the motor faders send the positions they coalesced
     }
 
+    if (g_surfaceLatencyDisplay)
+        latencyTrace_.Report(name_.c_str());
+
     if (isRewinding_)
     {
         if (GetCursorPosition() == 0)
@@ -3925,12 +4493,27 @@ void Midi_ControlSurfaceIO::HandleExternalInput(Midi_ControlSurface *surface)
 {
     if (midiInput_)
     {
-        midiInput_->SwapBufsPrecise(GetTickCount(), GetTickCount());
+        double now = time_precise();
+        midiInput_->SwapBufsPrecise(GetTickCount(), now);
         MIDI_eventlist *list = midiInput_->GetReadBuf();
         int bpos = 0;
         MIDI_event_t *evt;
         while ((evt = list->EnumItems(&bpos)))
-            surface->ProcessMidiMessage((MIDI_event_ex_t*)evt);
+        {
+            InvalidateShadow((MIDI_event_ex_t*)evt);
+            
+            // frame_offset is in 1/1024000 s from the previous swap, the first read has nothing to count from
+            double arrivalTime = 0.0;
+            
+            if (g_surfaceLatencyDisplay)
+                arrivalTime = lastSwapTime_ > 0.0 ? min(max(lastSwapTime_ + evt->frame_offset / 1024000.0, lastSwapTime_), now) : now;
+            
+            surface->AddInputMidiMessage((MIDI_event_ex_t*)evt, arrivalTime);
+        }
+        
+        lastSwapTime_ = now;
+        
+        surface->ProcessInputMidiMessages();
     }
 }
 
@@ -3946,7 +4529,26 @@ Midi_ControlSurface::Midi_ControlSurface(CSurfIntegrator *const csi, Page *page,
     InitZoneManager(csi_, this, zoneFolder, fxZoneFolder);
 }
 
-void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t *evt)
+CSIMessageGenerator *Midi_ControlSurface::GetMidiMessageGenerator(const MIDI_event_ex_t *evt)
+{
+    string threeByteKey = to_string(evt->midi_message[0]  * 0x10000 + evt->midi_message[1]  * 0x100 + evt->midi_message[2]);
+    string twoByteKey = to_string(evt->midi_message[0]  * 0x10000 + evt->midi_message[1]  * 0x100);
+    string oneByteKey = to_string(evt->midi_message[0] * 0x10000);
+
+    // At this point we don't know how much of the message comprises the key, so try all three
+    map<const string, unique_ptr<CSIMessageGenerator>>::iterator it;
+    
+    if ((it = CSIMessageGeneratorsByMessage_.find(threeByteKey)) != CSIMessageGeneratorsByMessage_.end())
+        return it->second.get();
+    else if ((it = CSIMessageGeneratorsByMessage_.find(twoByteKey)) != CSIMessageGeneratorsByMessage_.end())
+        return it->second.get();
+    else if ((it = CSIMessageGeneratorsByMessage_.find(oneByteKey)) != CSIMessageGeneratorsByMessage_.end())
+        return it->second.get();
+    
+    return NULL;
+}
+
+void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t *evt, CSIMessageGenerator *generator, double arrivalTime)
 {
     if (g_surfaceRawInDisplay)
     {
@@ -3954,22 +4556,110 @@ void Midi_ControlSurface::ProcessMidiMessage(const MIDI_event_ex_t *evt)
         // LogStackTraceToConsole();
     }
 
-    string threeByteKey = to_string(evt->midi_message[0]  * 0x10000 + evt->midi_message[1]  * 0x100 + evt->midi_message[2]);
-    string twoByteKey = to_string(evt->midi_message[0]  * 0x10000 + evt->midi_message[1]  * 0x100);
-    string oneByteKey = to_string(evt->midi_message[0] * 0x10000);
+    if (generator)
+    {
+        BeginInputDispatch(generator, arrivalTime);
+        generator->ProcessMidiMessage(evt);
+        EndInputDispatch(generator, arrivalTime);
+    }
+}
 
-    // At this point we don't know how much of the message comprises the key, so try all three
-    if (CSIMessageGeneratorsByMessage_.find(threeByteKey) != CSIMessageGeneratorsByMessage_.end())
-        CSIMessageGeneratorsByMessage_[threeByteKey]->ProcessMidiMessage(evt);
-    else if (CSIMessageGeneratorsByMessage_.find(twoByteKey) != CSIMessageGeneratorsByMessage_.end())
-        CSIMessageGeneratorsByMessage_[twoByteKey]->ProcessMidiMessage(evt);
-    else if (CSIMessageGeneratorsByMessage_.find(oneByteKey) != CSIMessageGeneratorsByMessage_.end())
-        CSIMessageGeneratorsByMessage_[oneByteKey]->ProcessMidiMessage(evt);
+void Midi_ControlSurface::AddInputMidiMessage(const MIDI_event_ex_t *evt, double arrivalTime)
+{
+    g_traceRing.Record(evt->size <= 3 ? TraceEvent_MidiIn : TraceEvent_SysExIn, symbol_, 0, evt->size, evt->midi_message);
+    
+    inputMidiMessages_.push_back(evt);
+    inputGenerators_.push_back(GetMidiMessageGenerator(evt));
+    inputArrivalTimes_.push_back(arrivalTime);
+}
+
+void Midi_ControlSurface::ProcessInputMidiMessages()
+{
+    BeginInputBatch();
+    
+    DWORD now = GetTickCount();
+    
+    for (int i = 0; i < (int)inputMidiMessages_.size(); ++i)
+    {
+        const MIDI_event_ex_t *evt = inputMidiMessages_[i];
+        CSIMessageGenerator *generator = inputGenerators_[i];
+        
+        // sysex is never coalesced, a fader move is only acted on once per batch with its latest position
+        if (evt->size <= 3 && GetIsSupersededInBatch(i))
+        {
+            if (g_surfaceRawInDisplay)
+                LogToConsole(256, "IN <- %s %02x %02x %02x (superseded)\n", name_.c_str(), evt->midi_message[0], evt->midi_message[1], evt->midi_message[2]);
+            
+            continue;
+        }
+        
+        if (evt->size <= 3 && GetShouldParkInput(generator, now))
+        {
+            ParkedMidiMessage &parked = parkedMidiMessages_[generator];
+            parked.evt = *evt;
+            parked.arrivalTime = inputArrivalTimes_[i];
+            continue;
+        }
+        
+        if (generator != NULL)
+            DispatchParkedMidiMessages(generator);
+        
+        ProcessMidiMessage(evt, generator, inputArrivalTimes_[i]);
+    }
+    
+    inputMidiMessages_.clear();
+    inputGenerators_.clear();
+    inputArrivalTimes_.clear();
+    
+    DispatchDueMidiMessages(now);
+}
+
+void Midi_ControlSurface::DispatchParkedMidiMessages(CSIMessageGenerator *generator)
+{
+    // whatever is parked for the widget goes first, so e.g. a touch release still comes after the last fader move,
+    // a value parked by the generator itself is superseded by the one about to be dispatched
+    for (auto it = parkedMidiMessages_.begin(); it != parkedMidiMessages_.end(); )
+    {
+        if (it->first->GetWidget() != generator->GetWidget())
+        {
+            ++it;
+            continue;
+        }
+        
+        CSIMessageGenerator *parkedGenerator = it->first;
+        ParkedMidiMessage parked = it->second;
+        parkedMidiMessages_.erase(it);
+        
+        if (parkedGenerator != generator)
+            ProcessMidiMessage(&parked.evt, parkedGenerator, parked.arrivalTime);
+        
+        it = parkedMidiMessages_.begin(); // the action may have banked and dropped the rest
+    }
+}
+
+void Midi_ControlSurface::DispatchDueMidiMessages(DWORD now)
+{
+    for (auto it = parkedMidiMessages_.begin(); it != parkedMidiMessages_.end(); )
+    {
+        if ( ! GetIsParkedInputDue(it->first, now))
+        {
+            ++it;
+            continue;
+        }
+        
+        CSIMessageGenerator *parkedGenerator = it->first;
+        ParkedMidiMessage parked = it->second;
+        parkedMidiMessages_.erase(it);
+        
+        ProcessMidiMessage(&parked.evt, parkedGenerator, parked.arrivalTime);
+        
+        it = parkedMidiMessages_.begin(); // the action may have banked and dropped the rest
+    }
 }
 
-void Midi_ControlSurface::SendMidiSysExMessage(MIDI_event_ex_t *midiMessage)
+void Midi_ControlSurface::SendMidiSysExMessage(MIDI_event_ex_t *midiMessage, Midi_FeedbackProcessor *processor)
 {
-    surfaceIO_->QueueMidiSysExMessage(midiMessage);
+    surfaceIO_->QueueMidiSysExMessage(midiMessage, processor, processor != NULL ? processor->GetWidget()->TakeLatencyEcho() : LatencyEcho());
     
     if (g_surfaceOutDisplay)
     {
@@ -3991,9 +4681,9 @@ void Midi_ControlSurface::SendMidiSysExMessage(MIDI_event_ex_t *midiMessage)
     }
 }
 
-void Midi_ControlSurface::SendMidiMessage(int first, int second, int third)
+void Midi_ControlSurface::SendMidiMessage(int first, int second, int third, bool isFeedback, const LatencyEcho &echo)
 {
-    surfaceIO_->SendMidiMessage(first, second, third);
+    surfaceIO_->SendMidiMessage(first, second, third, isFeedback, echo);
     
     if (g_surfaceOutDisplay) LogToConsole(256, "%s %02x %02x %02x # Midi_ControlSurface::SendMidiMessage\n", ("OUT->" + name_).c_str(), first, second, third);
 }
@@ -4004,7 +4694,7 @@ void Midi_ControlSurface::SendMidiMessage(int first, int second, int third)
 
 OSC_X32ControlSurfaceIO::OSC_X32ControlSurfaceIO(CSurfIntegrator *const csi, const char *surfaceName, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun) : OSC_ControlSurfaceIO(csi, surfaceName, channelCount, receiveOnPort, transmitToPort, transmitToIpAddress, maxPacketsPerRun) {}
 
-OSC_ControlSurfaceIO::OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *surfaceName, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun) : csi_(csi), name_(surfaceName), channelCount_(channelCount)
+OSC_ControlSurfaceIO::OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *surfaceName, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun) : csi_(csi), name_(surfaceName), symbol_(InternSymbol(surfaceName)), channelCount_(channelCount)
 {
     // private:
     maxPacketsPerRun_ = maxPacketsPerRun < 0 ? 0 : maxPacketsPerRun;
@@ -4075,25 +4765,31 @@ void OSC_ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
    {
        while (inSocket_->receiveNextPacket(0))  // timeout, in ms
        {
+           double arrivalTime = g_surfaceLatencyDisplay ? time_precise() : 0.0; // UDP keeps no arrival time, this is when it's taken off the socket
+           
            packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
            oscpkt::Message *message;
            
            while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
            {
+               InvalidateShadow(message->addressPattern());
+               
                if (message->arg().isFloat())
                {
                    float value = 0;
                    message->arg().popFloat(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+                   surface->AddInputOSCMessage(message->addressPattern().c_str(), value, arrivalTime);
                }
                else if (message->arg().isInt32())
                {
                    int value;
                    message->arg().popInt32(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+                   surface->AddInputOSCMessage(message->addressPattern().c_str(), value, arrivalTime);
                }
            }
        }
+       
+       surface->ProcessInputOSCMessages();
    }
 }
 
@@ -4103,16 +4799,32 @@ void OSC_X32ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
    {
        while (inSocket_->receiveNextPacket(0))  // timeout, in ms
        {
+           double arrivalTime = g_surfaceLatencyDisplay ? time_precise() : 0.0;
+           
            packetReader_.init(inSocket_->packetData(), inSocket_->packetSize());
            oscpkt::Message *message;
            
            while (packetReader_.isOk() && (message = packetReader_.popMessage()) != 0)
            {
+               const string &oscAddress = message->addressPattern();
+               
+               if (oscAddress == "/xinfo")
+               {
+                   HandleInfo(message);
+                   continue;
+               }
+               
+               // selidx is rewritten into one address per channel below, and the input logs want to see everything
+               if (oscAddress != "/-stat/selidx" && subscriptions_.count(oscAddress) == 0 && ! g_surfaceInDisplay && ! g_surfaceRawInDisplay)
+                   continue;
+               
+               InvalidateShadow(oscAddress);
+               
                if (message->arg().isFloat())
                {
                    float value = 0;
                    message->arg().popFloat(value);
-                   surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+                   surface->AddInputOSCMessage(message->addressPattern().c_str(), value, arrivalTime);
                }
                else if (message->arg().isInt32())
                {
@@ -4130,13 +4842,15 @@ void OSC_X32ControlSurfaceIO::HandleExternalInput(OSC_ControlSurface *surface)
                        snprintf(buf, sizeof(buf), "%d", value);
                        x32Select += buf;
                                               
-                       surface->ProcessOSCMessage(x32Select.c_str(), 1.0);
+                       surface->AddInputOSCMessage(x32Select.c_str(), 1.0, arrivalTime);
                    }
                    else
-                       surface->ProcessOSCMessage(message->addressPattern().c_str(), value);
+                       surface->AddInputOSCMessage(message->addressPattern().c_str(), value, arrivalTime);
                }
            }
        }
+       
+       surface->ProcessInputOSCMessages();
    }
 }
 
@@ -4149,65 +4863,183 @@ OSC_ControlSurface::OSC_ControlSurface(CSurfIntegrator *const csi, Page *page, c
     ProcessOSCWidgetFile(templateFilename);
     InitHardwiredWidgets(this);
     InitZoneManager(csi_, this, zoneFolder, fxZoneFolder);
+    
+    for (auto &generator : CSIMessageGeneratorsByMessage_)
+        surfaceIO_->AddSubscription(generator.first);
 }
 
-void OSC_ControlSurface::ProcessOSCMessage(const char *message, double value)
+void OSC_ControlSurface::ProcessOSCMessage(const char *message, double value, CSIMessageGenerator *generator, double arrivalTime)
 {
-    if (CSIMessageGeneratorsByMessage_.find(message) != CSIMessageGeneratorsByMessage_.end())
-        CSIMessageGeneratorsByMessage_[message]->ProcessMessage(value);
+    if (generator)
+    {
+        BeginInputDispatch(generator, arrivalTime);
+        generator->ProcessMessage(value);
+        EndInputDispatch(generator, arrivalTime);
+    }
     
     if (g_surfaceInDisplay) LogToConsole(MEDBUF, "IN <- %s %s %f\n", name_.c_str(), message, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(const char *zoneName)
+void OSC_ControlSurface::AddInputOSCMessage(const char *message, double value, double arrivalTime)
+{
+    inputOSCMessages_.push_back(make_pair(string(message), value));
+    inputArrivalTimes_.push_back(arrivalTime);
+    
+    map<const string, unique_ptr<CSIMessageGenerator>>::iterator it = CSIMessageGeneratorsByMessage_.find(inputOSCMessages_.back().first);
+    
+    if (it != CSIMessageGeneratorsByMessage_.end())
+    {
+        g_traceRing.Record(TraceEvent_OSCIn, symbol_, it->second->GetOSCAddressSymbol(), value);
+        
+        it->second->AddInputValue(value);
+        inputGenerators_.push_back(it->second.get());
+    }
+    else
+    {
+        g_traceRing.Record(TraceEvent_OSCIn, symbol_, CSISymbol_None, value); // nothing listens to it, not worth a symbol
+        
+        inputGenerators_.push_back(NULL);
+    }
+}
+
+void OSC_ControlSurface::AddOSCMessageGenerator(const string &oscAddress, unique_ptr<CSIMessageGenerator> generator)
+{
+    generator->SetOSCAddressSymbol(InternSymbol(oscAddress.c_str()));
+    CSIMessageGeneratorsByMessage_.insert(make_pair(oscAddress, move(generator)));
+}
+
+void OSC_ControlSurface::ProcessInputOSCMessages()
+{
+    BeginInputBatch();
+    
+    DWORD now = GetTickCount();
+    
+    for (int i = 0; i < (int)inputOSCMessages_.size(); ++i)
+    {
+        CSIMessageGenerator *generator = inputGenerators_[i];
+        
+        // a fader move is only acted on once per batch with its latest position
+        if (GetIsSupersededInBatch(i))
+        {
+            if (g_surfaceInDisplay) LogToConsole(MEDBUF, "IN <- %s %s %f (superseded)\n", name_.c_str(), inputOSCMessages_[i].first.c_str(), inputOSCMessages_[i].second);
+            
+            continue;
+        }
+        
+        if (GetShouldParkInput(generator, now))
+        {
+            ParkedOSCMessage &parked = parkedOSCMessages_[generator];
+            parked.oscAddress = inputOSCMessages_[i].first;
+            parked.value = inputOSCMessages_[i].second;
+            parked.arrivalTime = inputArrivalTimes_[i];
+            continue;
+        }
+        
+        if (generator != NULL)
+            DispatchParkedOSCMessages(generator);
+        
+        ProcessOSCMessage(inputOSCMessages_[i].first.c_str(), inputOSCMessages_[i].second, generator, inputArrivalTimes_[i]);
+    }
+    
+    inputOSCMessages_.clear();
+    inputGenerators_.clear();
+    inputArrivalTimes_.clear();
+    
+    DispatchDueOSCMessages(now);
+}
+
+void OSC_ControlSurface::DispatchParkedOSCMessages(CSIMessageGenerator *generator)
+{
+    // whatever is parked for the widget goes first, so e.g. a touch release still comes after the last fader move,
+    // a value parked by the generator itself is superseded by the one about to be dispatched
+    for (auto it = parkedOSCMessages_.begin(); it != parkedOSCMessages_.end(); )
+    {
+        if (it->first->GetWidget() != generator->GetWidget())
+        {
+            ++it;
+            continue;
+        }
+        
+        CSIMessageGenerator *parkedGenerator = it->first;
+        ParkedOSCMessage parked = it->second;
+        parkedOSCMessages_.erase(it);
+        
+        if (parkedGenerator != generator)
+            ProcessOSCMessage(parked.oscAddress.c_str(), parked.value, parkedGenerator, parked.arrivalTime);
+        
+        it = parkedOSCMessages_.begin(); // the action may have banked and dropped the rest
+    }
+}
+
+void OSC_ControlSurface::DispatchDueOSCMessages(DWORD now)
+{
+    for (auto it = parkedOSCMessages_.begin(); it != parkedOSCMessages_.end(); )
+    {
+        if ( ! GetIsParkedInputDue(it->first, now))
+        {
+            ++it;
+            continue;
+        }
+        
+        CSIMessageGenerator *parkedGenerator = it->first;
+        ParkedOSCMessage parked = it->second;
+        parkedOSCMessages_.erase(it);
+        
+        ProcessOSCMessage(parked.oscAddress.c_str(), parked.value, parkedGenerator, parked.arrivalTime);
+        
+        it = parkedOSCMessages_.begin(); // the action may have banked and dropped the rest
+    }
+}
+
+void OSC_ControlSurface::SendOSCMessage(const char *zoneName, int addressSymbol)
 {
     string oscAddress(zoneName);
     ReplaceAllWith(oscAddress, s_BadFileChars, "_");
     oscAddress = "/" + oscAddress;
 
-    surfaceIO_->SendOSCMessage(oscAddress.c_str());
+    surfaceIO_->SendOSCMessage(oscAddress.c_str(), addressSymbol);
         
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "->LoadingZone---->%s\n", name_.c_str());
 }
 
-void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, int value)
+void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, int addressSymbol, int value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCMessage(oscAddress, addressSymbol, value);
         
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %d # Surface::SendOSCMessage 1\n", name_.c_str(), oscAddress, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, double value)
+void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, int addressSymbol, double value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCMessage(oscAddress, addressSymbol, value);
         
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %f # Surface::SendOSCMessage 2\n", name_.c_str(), oscAddress, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, const char *value)
+void OSC_ControlSurface::SendOSCMessage(const char *oscAddress, int addressSymbol, const char *value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCMessage(oscAddress, addressSymbol, value);
         
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %s # Surface::SendOSCMessage 3\n", name_.c_str(), oscAddress, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, double value)
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, double value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCFeedbackMessage(oscAddress, addressSymbol, value, feedbackProcessor->GetWidget()->TakeLatencyEcho());
     
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %f # Surface::SendOSCMessage 4\n", feedbackProcessor->GetWidget()->GetName(), oscAddress, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int value)
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, int value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCFeedbackMessage(oscAddress, addressSymbol, value, feedbackProcessor->GetWidget()->TakeLatencyEcho());
 
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %s %d # Surface::SendOSCMessage 5\n", name_.c_str(), feedbackProcessor->GetWidget()->GetName(), oscAddress, value);
 }
 
-void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, const char *value)
+void OSC_ControlSurface::SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, const char *value)
 {
-    surfaceIO_->SendOSCMessage(oscAddress, value);
+    surfaceIO_->SendOSCFeedbackMessage(oscAddress, addressSymbol, value, feedbackProcessor->GetWidget()->TakeLatencyEcho());
 
     if (g_surfaceOutDisplay) LogToConsole(MEDBUF, "OUT->%s %s %s %s # Surface::SendOSCMessage 6\n", name_.c_str(), feedbackProcessor->GetWidget()->GetName(), oscAddress, value);
 }
@@ -4289,33 +5121,573 @@ void Midi_ControlSurface::InitializeMCUXT()
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-// CSurfIntegrator
+// FXParamCache
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-static const char * const Control_Surface_Integrator = "Control Surface Integrator";
+static const char *s_dynamicFXParamVersion = "dynamic";
 
-CSurfIntegrator::CSurfIntegrator()
+bool FXParamCache::GetIdent(MediaTrack *track, int fxIndex, string &ident)
 {
-    InitActionsDictionary();
-
-    int size = 0;
-    int index = projectconfig_var_getoffs("projtimemode", &size);
-    timeModeOffs_ = size==4 ? index : -1;
+    char buf[MEDBUF];
     
-    index = projectconfig_var_getoffs("projtimemode2", &size);
-    timeMode2Offs_ = size==4 ? index : -1;
+    if ( ! TrackFX_GetNamedConfigParm(track, fxIndex, "fx_ident", buf, sizeof(buf)) || buf[0] == 0)
+        return false;
     
-    index = projectconfig_var_getoffs("projmeasoffs", &size);
-    measOffsOffs_ = size==4 ? index : - 1;
+    ident = buf;
     
-    index = projectconfig_var_getoffs("projtimeoffs", &size);
-    timeOffsOffs_ = size==8 ? index : -1;
+    if (TrackFX_GetNamedConfigParm(track, fxIndex, "fx_type", buf, sizeof(buf)) && ! strcmp(buf, "JS"))
+        return false;
     
-    index = projectconfig_var_getoffs("panmode", &size);
-    projectPanModeOffs_ = size==4 ? index : -1;
+    return true;
+}
 
-    // these are supported by ~7.10+, previous versions we fallback to get_config_var() on-demand
-    index = projectconfig_var_getoffs("projmetrov1", &size);
-    projectMetronomePrimaryVolumeOffs_ = size==8 ? index : -1;
+string FXParamCache::GetVersion(const string &ident, int numParams)
+{
+    // VST/CLAP idents are the plugin file followed by <id or {uid, a rebuilt plugin has a new file time
+    string pluginFile = ident.substr(0, ident.find_first_of("<{"));
+    long long fileTime = 0;
+    
+    error_code ec;
+    if (pluginFile.size() > 0 && filesystem::is_regular_file(pluginFile, ec))
+    {
+        filesystem::file_time_type writeTime = filesystem::last_write_time(pluginFile, ec);
+        if ( ! ec)
+            fileTime = (long long)writeTime.time_since_epoch().count();
+    }
+    
+    return to_string(numParams) + " " + to_string(fileTime);
+}
+
+string FXParamCache::GetFilePath(const string &ident)
+{
+    char fileName[SMLBUF];
+    snprintf(fileName, sizeof(fileName), "%016llx.txt", (unsigned long long)hash<string>()(ident));
+    
+    return string(GetResourcePath()) + "/CSI/FXParamCache/" + fileName;
+}
+
+static void GetTabFields(const string &line, vector<string> &fields)
+{
+    fields.clear();
+    
+    size_t start = 0;
+    
+    for (size_t tab = line.find('\t'); tab != string::npos; tab = line.find('\t', start))
+    {
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    
+    fields.push_back(line.substr(start));
+}
+
+static string GetTabSafe(const char *text)
+{
+    string safe(text);
+    
+    for (auto &c : safe)
+        if (c == '\t' || c == '\r' || c == '\n')
+            c = ' ';
+    
+    return safe;
+}
+
+bool FXParamCache::Read(const string &ident, FXParamMetadata &metadata)
+{
+    ifstream cacheFile(GetFilePath(ident));
+    
+    if ( ! cacheFile.is_open())
+        return false;
+    
+    vector<string> fields;
+    string line;
+    
+    // first line is FXParamCache <tab> ident <tab> version, then index <tab> name <tab> steps <tab> min <tab> max
+    if ( ! getline(cacheFile, line))
+        return false;
+    
+    GetTabFields(line, fields);
+    
+    if (fields.size() != 3 || fields[0] != "FXParamCache" || fields[1] != ident)
+        return false;
+    
+    metadata.ident = ident;
+    metadata.version = fields[2];
+    metadata.params.clear();
+    
+    if (metadata.version == s_dynamicFXParamVersion)
+        return true;
+    
+    while (getline(cacheFile, line))
+    {
+        GetTabFields(line, fields);
+        
+        if (fields.size() != 5 || atoi(fields[0].c_str()) != (int)metadata.params.size())
+            return false;
+        
+        FXParamInfo info;
+        info.name = fields[1];
+        info.numSteps = atoi(fields[2].c_str());
+        info.minValue = fields[3];
+        info.maxValue = fields[4];
+        metadata.params.push_back(info);
+    }
+    
+    return to_string(metadata.params.size()) == metadata.version.substr(0, metadata.version.find(' '));
+}
+
+void FXParamCache::Write(const FXParamMetadata &metadata)
+{
+    string folder = string(GetResourcePath()) + "/CSI/FXParamCache";
+    
+    if ( ! filesystem::exists(folder))
+        RecursiveCreateDirectory(folder.c_str(), 0);
+
+    string contents = "FXParamCache\t" + GetTabSafe(metadata.ident.c_str()) + "\t" + metadata.version + "\n";
+    
+    for (int i = 0; i < (int)metadata.params.size(); ++i)
+    {
+        const FXParamInfo &info = metadata.params[i];
+        contents += to_string(i) + "\t" + info.name + "\t" + to_string(info.numSteps) + "\t" + info.minValue + "\t" + info.maxValue + "\n";
+    }
+    
+    fileWriter_.QueueFile(GetFilePath(metadata.ident), move(contents));
+}
+
+void FXParamCache::GetParamInfo(MediaTrack *track, int fxIndex, int paramIndex, FXParamInfo &info)
+{
+    char buf[MEDBUF];
+    
+    buf[0] = 0;
+    TrackFX_GetParamName(track, fxIndex, paramIndex, buf, sizeof(buf));
+    info.name = GetTabSafe(buf);
+    
+    double step = 0.0, smallStep = 0.0, largeStep = 0.0;
+    bool isToggle = false;
+    
+    if (TrackFX_GetParameterStepSizes(track, fxIndex, paramIndex, &step, &smallStep, &largeStep, &isToggle))
+    {
+        double minValue = 0.0, maxValue = 0.0, midValue = 0.0;
+        TrackFX_GetParamEx(track, fxIndex, paramIndex, &minValue, &maxValue, &midValue);
+        
+        if (isToggle)
+            info.numSteps = 2;
+        else if (step > 0.0 && maxValue > minValue)
+            info.numSteps = (int)((maxValue - minValue) / step + 0.5) + 1;
+        
+        if (info.numSteps > g_maxNumParamSteps)
+            info.numSteps = 0;
+    }
+    
+    buf[0] = 0;
+    if (TrackFX_FormatParamValueNormalized(track, fxIndex, paramIndex, 0.0, buf, sizeof(buf)))
+        info.minValue = GetTabSafe(buf);
+    
+    buf[0] = 0;
+    if (TrackFX_FormatParamValueNormalized(track, fxIndex, paramIndex, 1.0, buf, sizeof(buf)))
+        info.maxValue = GetTabSafe(buf);
+}
+
+int FXParamCache::FindFX(MediaTrack *track, int fxIndex, const string &fxGUID)
+{
+    if ( ! DAW::ValidateTrackPtr(track))
+        return -1;
+    
+    char guid[SMLBUF];
+    int numFX = TrackFX_GetCount(track);
+    
+    if (fxIndex < numFX)
+    {
+        guidToString(TrackFX_GetFXGUID(track, fxIndex), guid);
+        
+        if (fxGUID == guid)
+            return fxIndex;
+    }
+    
+    for (int i = 0; i < numFX; ++i)
+    {
+        guidToString(TrackFX_GetFXGUID(track, i), guid);
+        
+        if (fxGUID == guid)
+            return i;
+    }
+    
+    return -1;
+}
+
+void FXParamCache::QueueEntry(MediaTrack *track, int fxIndex, const string &ident, const string &version, int numParams)
+{
+    PendingEntry &pending = pendingEntries_[ident];
+    
+    char guid[SMLBUF];
+    guidToString(TrackFX_GetFXGUID(track, fxIndex), guid);
+    
+    pending.track = track;
+    pending.fxIndex = fxIndex;
+    pending.fxGUID = guid;
+    pending.numParams = numParams;
+    pending.metadata.ident = ident;
+    pending.metadata.version = version;
+    pending.metadata.params.clear();
+}
+
+void FXParamCache::Run()
+{
+    if (pendingEntries_.empty())
+        return;
+    
+    auto it = pendingEntries_.begin();
+    PendingEntry &pending = it->second;
+    
+    // the FX was removed, or rebuilt with another count, the next lookup queues it again
+    pending.fxIndex = FindFX(pending.track, pending.fxIndex, pending.fxGUID);
+    
+    if (pending.fxIndex < 0 || TrackFX_GetNumParams(pending.track, pending.fxIndex) != pending.numParams)
+    {
+        pendingEntries_.erase(it);
+        return;
+    }
+    
+    vector<FXParamInfo> &params = pending.metadata.params;
+    
+    for (int i = 0; i < FXParamsPerRun && (int)params.size() < pending.numParams; ++i)
+    {
+        FXParamInfo info;
+        GetParamInfo(pending.track, pending.fxIndex, (int)params.size(), info);
+        params.push_back(info);
+    }
+    
+    if ((int)params.size() < pending.numParams)
+        return;
+    
+    Write(pending.metadata);
+    checkedInstances_.insert(pending.fxGUID); // the entry came from this instance
+    entries_[it->first] = make_unique<FXParamMetadata>(move(pending.metadata));
+    pendingEntries_.erase(it);
+}
+
+bool FXParamCache::GetIsInstanceChecked(MediaTrack *track, int fxIndex)
+{
+    char guid[SMLBUF];
+    guidToString(TrackFX_GetFXGUID(track, fxIndex), guid);
+    
+    return checkedInstances_.find(guid) != checkedInstances_.end();
+}
+
+bool FXParamCache::GetIsInstanceDynamic(MediaTrack *track, int fxIndex, const FXParamMetadata &metadata)
+{
+    char guid[SMLBUF];
+    guidToString(TrackFX_GetFXGUID(track, fxIndex), guid);
+    
+    if ( ! checkedInstances_.insert(guid).second)
+        return false;
+    
+    int numParams = (int)metadata.params.size();
+    
+    if (TrackFX_GetNumParams(track, fxIndex) != numParams)
+        return true;
+    
+    // first, middle and last names, enough to catch a plugin that renames its params per instance
+    int samples[] = { 0, numParams / 2, numParams - 1 };
+    char buf[MEDBUF];
+    
+    for (int i = 0; i < NUM_ELEM(samples) && numParams > 0; ++i)
+    {
+        buf[0] = 0;
+        TrackFX_GetParamName(track, fxIndex, samples[i], buf, sizeof(buf));
+        
+        if (GetTabSafe(buf) != metadata.params[samples[i]].name)
+            return true;
+    }
+    
+    return false;
+}
+
+const FXParamMetadata *FXParamCache::GetMetadata(MediaTrack *track, int fxIndex)
+{
+    if ( ! DAW::ValidateTrackPtr(track) || fxIndex < 0 || fxIndex >= TrackFX_GetCount(track))
+        return NULL;
+    
+    string ident;
+    
+    if ( ! GetIdent(track, fxIndex, ident) || dynamicIdents_.find(ident) != dynamicIdents_.end() || pendingEntries_.find(ident) != pendingEntries_.end())
+        return NULL;
+    
+    int numParams = TrackFX_GetNumParams(track, fxIndex);
+    
+    auto it = entries_.find(ident);
+    FXParamMetadata *metadata = it != entries_.end() ? it->second.get() : NULL;
+    
+    // a new instance with another param count is a dynamic plugin, the one the entry came from changing its count is a rebuilt one
+    if (metadata == NULL || ((int)metadata->params.size() != numParams && GetIsInstanceChecked(track, fxIndex)))
+    {
+        string version = GetVersion(ident, numParams);
+        
+        unique_ptr<FXParamMetadata> readMetadata = make_unique<FXParamMetadata>();
+        
+        bool isRead = Read(ident, *readMetadata);
+        
+        entries_.erase(ident);
+        
+        if (isRead && readMetadata->version == s_dynamicFXParamVersion)
+        {
+            dynamicIdents_.insert(ident);
+            return NULL;
+        }
+        
+        if ( ! isRead || readMetadata->version != version)
+        {
+            QueueEntry(track, fxIndex, ident, version, numParams);
+            return NULL;
+        }
+        
+        metadata = readMetadata.get();
+        entries_[ident] = move(readMetadata);
+    }
+    
+    if (GetIsInstanceDynamic(track, fxIndex, *metadata))
+    {
+        LogToConsole(256, "[NOTICE] %s names its params per instance, reading them live\n", ident.c_str());
+        
+        FXParamMetadata dynamicMetadata;
+        dynamicMetadata.ident = ident;
+        dynamicMetadata.version = s_dynamicFXParamVersion;
+        Write(dynamicMetadata);
+        
+        entries_.erase(ident);
+        dynamicIdents_.insert(ident);
+        return NULL;
+    }
+    
+    return metadata;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResourceFileWatcher
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ResourceFileWatcher::GetIsWatchedFile(const filesystem::path &filePath)
+{
+    return filePath.extension() == ".zon" || filePath.filename() == "CSI.ini" || filePath.filename() == "Surface.txt";
+}
+
+void ResourceFileWatcher::Start(const string &folder)
+{
+    string normalFolder = filesystem::path(folder).lexically_normal().string();
+    
+    if (normalFolder == folder_) // already watching, Init runs again on every reset
+        return;
+    
+    Stop();
+    
+    folder_ = normalFolder;
+    
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    
+    if (inotifyFd_ < 0)
+    {
+        LogToConsole(256, "[ERROR] FAILED to watch %s for changes, inotify_init1 returned %d\n", folder_.c_str(), errno);
+        return;
+    }
+    
+    AddWatches(folder_);
+#else
+    thread_ = thread(&ResourceFileWatcher::Run, this, folder_);
+#endif
+}
+
+void ResourceFileWatcher::Stop()
+{
+#ifdef __linux__
+    if (inotifyFd_ >= 0)
+        close(inotifyFd_); // takes the watches with it
+    
+    inotifyFd_ = -1;
+    watchedFolders_.clear();
+#else
+    if (thread_.joinable())
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            shouldStop_ = true;
+        }
+        
+        wake_.notify_one();
+        thread_.join();
+    }
+    
+    shouldStop_ = false;
+    changedFiles_.clear();
+    fileTimes_.clear();
+#endif
+    
+    folder_.clear();
+}
+
+#ifdef __linux__
+void ResourceFileWatcher::AddWatches(const string &folder)
+{
+    // inotify only watches the folder itself, so every sub folder gets its own watch
+    int watch = inotify_add_watch(inotifyFd_, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    
+    if (watch < 0)
+    {
+        if (g_debugLevel >= DEBUG_LEVEL_WARNING) LogToConsole(256, "[WARNING] Unable to watch %s for changes\n", folder.c_str());
+        return;
+    }
+    
+    if (watchedFolders_.find(watch) != watchedFolders_.end()) // same inode, a link back up the tree
+        return;
+    
+    watchedFolders_[watch] = folder;
+    
+    error_code error;
+    
+    for (filesystem::directory_iterator it(folder, error), end; ! error && it != end; it.increment(error))
+    {
+        error_code typeError;
+        
+        if (it->is_directory(typeError))
+            AddWatches(it->path().lexically_normal().string());
+    }
+}
+
+void ResourceFileWatcher::GetChangedFiles(set<string> &changedFiles)
+{
+    if (inotifyFd_ < 0)
+        return;
+    
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    
+    while ((length = read(inotifyFd_, buffer, sizeof(buffer))) > 0)
+    {
+        for (char *next = buffer; next < buffer + length; )
+        {
+            const inotify_event *event = (const inotify_event *)next;
+            next += sizeof(inotify_event) + event->len;
+            
+            auto it = watchedFolders_.find(event->wd);
+            
+            if (it == watchedFolders_.end())
+                continue;
+            
+            if (event->mask & IN_IGNORED) // the folder was removed
+            {
+                watchedFolders_.erase(it);
+                continue;
+            }
+            
+            if (event->len == 0)
+                continue;
+            
+            filesystem::path filePath = filesystem::path(it->second) / event->name;
+            
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddWatches(filePath.lexically_normal().string());
+            }
+            else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) && GetIsWatchedFile(filePath)) // editors that save to a temp file and rename arrive as IN_MOVED_TO
+                changedFiles.insert(filePath.lexically_normal().string());
+        }
+    }
+}
+#else
+void ResourceFileWatcher::Run(string folder)
+{
+    Scan(folder, NULL);
+    
+    unique_lock<mutex> lock(mutex_);
+    
+    while ( ! wake_.wait_for(lock, chrono::seconds(2), [this] { return shouldStop_; }))
+    {
+        lock.unlock();
+        
+        set<string> changedFiles;
+        Scan(folder, &changedFiles);
+        
+        lock.lock();
+        
+        changedFiles_.insert(changedFiles.begin(), changedFiles.end());
+    }
+}
+
+void ResourceFileWatcher::Scan(const string &folder, set<string> *changedFiles)
+{
+    error_code error;
+    
+    for (filesystem::recursive_directory_iterator it(folder, error), end; ! error && it != end; it.increment(error))
+    {
+        error_code fileError;
+        
+        if (it->is_directory(fileError))
+        {
+            // written by CSI itself and can hold thousands of files, nothing in them is ever reloaded
+            if (it->path().filename() == "ZoneRawFXFiles" || it->path().filename() == "FXParamCache")
+                it.disable_recursion_pending();
+            
+            continue;
+        }
+        
+        if ( ! it->is_regular_file(fileError) || ! GetIsWatchedFile(it->path()))
+            continue;
+        
+        filesystem::file_time_type fileTime = it->last_write_time(fileError);
+        
+        if (fileError)
+            continue;
+        
+        string filePath = it->path().lexically_normal().string();
+        
+        auto found = fileTimes_.find(filePath);
+        
+        if (found == fileTimes_.end() || found->second != fileTime)
+        {
+            if (changedFiles != NULL)
+                changedFiles->insert(filePath);
+            
+            fileTimes_[filePath] = fileTime;
+        }
+    }
+}
+
+void ResourceFileWatcher::GetChangedFiles(set<string> &changedFiles)
+{
+    lock_guard<mutex> lock(mutex_);
+    
+    changedFiles.insert(changedFiles_.begin(), changedFiles_.end());
+    changedFiles_.clear();
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CSurfIntegrator
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const char * const Control_Surface_Integrator = "Control Surface Integrator";
+
+CSurfIntegrator::CSurfIntegrator()
+{
+    InitActionsDictionary();
+
+    int size = 0;
+    int index = projectconfig_var_getoffs("projtimemode", &size);
+    timeModeOffs_ = size==4 ? index : -1;
+    
+    index = projectconfig_var_getoffs("projtimemode2", &size);
+    timeMode2Offs_ = size==4 ? index : -1;
+    
+    index = projectconfig_var_getoffs("projmeasoffs", &size);
+    measOffsOffs_ = size==4 ? index : - 1;
+    
+    index = projectconfig_var_getoffs("projtimeoffs", &size);
+    timeOffsOffs_ = size==8 ? index : -1;
+    
+    index = projectconfig_var_getoffs("panmode", &size);
+    projectPanModeOffs_ = size==4 ? index : -1;
+
+    // these are supported by ~7.10+, previous versions we fallback to get_config_var() on-demand
+    index = projectconfig_var_getoffs("projmetrov1", &size);
+    projectMetronomePrimaryVolumeOffs_ = size==8 ? index : -1;
 
     index = projectconfig_var_getoffs("projmetrov2", &size);
     projectMetronomeSecondaryVolumeOffs_ = size==8 ? index : -1;
@@ -4357,6 +5729,13 @@ int CSurfIntegrator::Extended(int call, void *parm1, void *parm2, void *parm3)
     if (call == CSURF_EXT_RESET)
     {
        Init();
+       StartIOTimer();
+    }
+    
+    if (call == CSURF_EXT_SETLASTTOUCHEDFX || call == CSURF_EXT_SETFXPARAM)
+    {
+        // the Learn window follows the last touched param from these rather than polling
+        UpdateLearnWindow();
     }
     
     if (call == CSURF_EXT_SETFXCHANGE)
@@ -4382,6 +5761,83 @@ int CSurfIntegrator::Extended(int call, void *parm1, void *parm2, void *parm3)
     return 1;
 }
 
+static const UINT s_ioTimerInterval = 5; // ms asked for, Windows rounds it up to its timer resolution
+static CSurfIntegrator *s_ioTimerCSI = NULL;
+
+void CALLBACK CSurfIntegrator::IOTimerProc(HWND hwnd, UINT msg, UINT_PTR timerId, DWORD time)
+{
+    if (s_ioTimerCSI)
+        s_ioTimerCSI->HandleIOTimer();
+}
+
+void CSurfIntegrator::StartIOTimer()
+{
+    if (ioTimerId_ != 0)
+        return;
+    
+    s_ioTimerCSI = this;
+    ioTimerId_ = SetTimer(NULL, 0, s_ioTimerInterval, IOTimerProc);
+}
+
+void CSurfIntegrator::StopIOTimer()
+{
+    if (ioTimerId_ == 0)
+        return;
+    
+    KillTimer(NULL, ioTimerId_);
+    ioTimerId_ = 0;
+    
+    if (s_ioTimerCSI == this)
+        s_ioTimerCSI = NULL;
+}
+
+void CSurfIntegrator::HandlePageInput()
+{
+    // Run and the I/O timer both read input. A modal dialog opened by an action runs its own message loop, which can
+    // call either of them again: the inner one leaves the input alone, its SwapBufs would pull the batch being
+    // dispatched out from under the outer one.
+    if (isHandlingInput_)
+        return;
+    
+    isHandlingInput_ = true;
+    
+    try {
+        pages_[currentPageIndex_]->HandleExternalInput();
+    } catch (...) {
+        isHandlingInput_ = false;
+        throw;
+    }
+    
+    isHandlingInput_ = false;
+}
+
+void CSurfIntegrator::HandleIOTimer()
+{
+    if (isHandlingInput_ || ! shouldRun_ || isTrackListDirty_)
+        return;
+    
+    if (pages_.size() <= currentPageIndex_ || ! pages_[currentPageIndex_])
+        return;
+    
+    // a project tab switch is handled by the next Run, before any more input
+    if (currentProject_ != (*EnumProjects)(-1, NULL, 0))
+        return;
+    
+    isPollingBetweenRuns_ = true;
+    
+    try {
+        HandlePageInput();
+    } catch (const ReloadPluginException& e) {
+        if (g_debugLevel >= DEBUG_LEVEL_NOTICE) LogToConsole(256, "[NOTICE] RELOADING: : %s\n", e.what());
+        ResetWidgets();
+    } catch (const std::exception& e) {
+        LogToConsole(256, "[ERROR] # CSurfIntegrator::HandleIOTimer: %s\n", e.what());
+        LogStackTraceToConsole();
+    }
+    
+    isPollingBetweenRuns_ = false;
+}
+
 static IReaperControlSurface *createFunc(const char *type_string, const char *configString, int *errStats)
 {
     return new CSurfIntegrator();
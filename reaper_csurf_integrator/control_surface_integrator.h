@@ -35,6 +35,18 @@
 
 #include <filesystem>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
 
 #ifdef USING_CMAKE
   #include "../lib/WDL/WDL/win32_utf8.h"
@@ -52,6 +64,8 @@
 #endif
 
 #include "control_surface_integrator_Reaper.h"
+#include "control_surface_color_palettes.h"
+#include "control_surface_trace.h"
 
 #include "handy_functions.h"
 
@@ -95,7 +109,7 @@ class Zone;
 
 extern void RequestFocusedFXDialog(ZoneManager *zoneManager);
 extern void CloseFocusedFXDialog();
-extern void UpdateLearnWindow(ZoneManager *zoneManager);
+extern void UpdateLearnWindow();
 extern void InitBlankLearnFocusedFXZone(ZoneManager *zoneManager, Zone *fxZone, MediaTrack *track, int fxSlot);
 extern void ShutdownLearn();
 
@@ -103,8 +117,12 @@ extern int g_debugLevel;
 extern bool g_surfaceRawInDisplay;
 extern bool g_surfaceInDisplay;
 extern bool g_surfaceOutDisplay;
+extern bool g_surfaceLatencyDisplay;
 extern bool g_fxParamsWrite;
 
+extern TraceRing g_traceRing;
+extern void SaveTrace();
+
 extern REAPER_PLUGIN_HINSTANCE g_hInst;
 
 static const int REAPER__CONTROL_SURFACE_REFRESH_ALL_SURFACES = 41743;
@@ -142,6 +160,58 @@ public:
     explicit ReloadPluginException(const std::string& message)
         : std::runtime_error(message) {}
 };
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+enum CSISymbol {
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Zone, widget and navigator names are interned when the templates load, the runtime compares ints.
+// Names that CSI itself gives a meaning to are pre-interned here so they can be used as constants.
+#define DECLARE_CSI_SYMBOLS(D) \
+  D(Home) \
+  D(Track) \
+  D(VCA) \
+  D(Folder) \
+  D(SelectedTracks) \
+  D(SelectedTrack) \
+  D(SelectedTrackSend) \
+  D(SelectedTrackReceive) \
+  D(SelectedTrackFX) \
+  D(SelectedTrackFXMenu) \
+  D(TrackSend) \
+  D(TrackReceive) \
+  D(TrackFXMenu) \
+  D(MasterTrack) \
+  D(MasterTrackFXMenu) \
+  D(FocusedFX) \
+  D(FXSlot) \
+  D(LastTouchedFXParam) \
+  D(OnTrackSelection) \
+  D(OnPageEnter) \
+  D(OnPageLeave) \
+  D(OnInitialization) \
+  D(OnPlayStart) \
+  D(OnPlayStop) \
+  D(OnRecordStart) \
+  D(OnRecordStop) \
+  D(OnZoneActivation) \
+  D(OnZoneDeactivation) \
+  D(TrackNavigator) \
+  D(MasterTrackNavigator) \
+  D(FocusedFXNavigator) \
+
+  CSISymbol_None = 0, // never interned
+#define DEFSYM(x) CSISymbol_##x ,
+  DECLARE_CSI_SYMBOLS(DEFSYM)
+#undef DEFSYM
+  CSISymbol_NumPredefined
+};
+
+extern int InternSymbol(const char *name);
+extern int FindSymbol(const char *name); // CSISymbol_None if the name was never interned
+extern const char *GetSymbolName(int symbol);
+extern int GetNumSymbols();
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 enum PropertyType {
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -182,6 +252,7 @@ enum PropertyType {
   D(MidiOutput) \
   D(MIDISurfaceRefreshRate) \
   D(MaxMIDIMesssagesPerRun) \
+  D(MaxMIDIBytesPerSecond) \
   D(ReceiveOnPort) \
   D(TransmitToPort) \
   D(TransmitToIPAddress) \
@@ -352,17 +423,39 @@ class Midi_ControlSurface;
 class OSC_ControlSurface;
 class TrackNavigationManager;
 class ActionContext;
+struct LatencyEcho;
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// How often an action context's feedback is refreshed. Faders, LEDs and meters are polled every tick,
+// the feedback processors only send what changed. The others skip ticks where nothing they show can have moved.
+enum UpdateClass
+{
+    UpdateClass_EveryTick = 0,
+    UpdateClass_OnStructureChange, // track list, track names, FX chains, bank or slot moves, or another writer on the widget
+    UpdateClass_Capped,            // at most every CappedUpdateIntervalMs
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Action
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+private:
+    int symbol_ = CSISymbol_None;
+    
 public:
     virtual ~Action() {}
     
     virtual const char *GetName() { return "Action"; }
+    
+    int GetSymbol()
+    {
+        if (symbol_ == CSISymbol_None)
+            symbol_ = InternSymbol(GetName());
+        
+        return symbol_;
+    }
+    virtual UpdateClass GetUpdateClass() { return UpdateClass_EveryTick; }
 
     virtual void Touch(ActionContext *context, double value) {}
     virtual void RequestUpdate(ActionContext *context) {}
@@ -510,6 +603,7 @@ private:
     int intParam_ = 0;
     
     string stringParam_;
+    int stringParamSymbol_ = -1; // interned on first use
     
     int paramIndex_ = 0;
     string fxParamDisplayName_;
@@ -551,6 +645,13 @@ private:
     bool supportsTrackColor_ = false;
         
     bool provideFeedback_= true;
+    
+    // state at the last RequestUpdate, see GetIsUpdateDue
+    int updateStructureGeneration_ = -1;
+    unsigned int updateWidgetWriteCount_ = 0;
+    MediaTrack *updateTrack_ = NULL;
+    int updateSlotIndex_ = 0;
+    DWORD lastUpdateTs_ = 0;
 
     char meterMode_[64] = "";
     char clipDetection_[64] = "";
@@ -564,8 +665,11 @@ private:
     void SetColor(const vector<string> &params, bool &supportsColor, bool &supportsTrackColor, vector<rgba_color> &colorValues);
     void GetColorValues(vector<rgba_color> &colorValues, const vector<string> &colors);
     void LogAction(double value);
+    bool GetIsUpdateDue();
 public:
     static int constexpr HOLD_DELAY_INHERIT_VALUE = -1;
+    static int constexpr CappedUpdateIntervalMs = 25; // under the 33 ms tick with room for timer jitter, so once a tick and never more often
+    static int constexpr StructureUpdateIntervalMs = 1000; // catches changes REAPER doesn't notify
     static double constexpr BUTTON_RELEASE_MESSAGE_VALUE = 0.0;
     ActionContext(CSurfIntegrator *const csi, Action *action, Widget *widget, Zone *zone, int paramIndex, const vector<string> &params);
 
@@ -605,7 +709,8 @@ public:
     void SetHoldDelay(int value) { holdDelayMs_ = value; }
     int GetHoldDelay() { return holdDelayMs_; }
     
-    void SetAction(Action *action) { action_ = action; RequestUpdate(); }
+    void SetAction(Action *action) { action_ = action; InvalidateUpdate(); RequestUpdate(); }
+    void InvalidateUpdate() { updateStructureGeneration_ = -1; }
     void DoAction(double value);
     void PerformAction(double value);
     void DoRelativeAction(double value);
@@ -621,6 +726,14 @@ public:
     void UpdateColorValue(double value);
 
     const char *GetStringParam() { return stringParam_.c_str(); }
+    
+    int GetStringParamSymbol()
+    {
+        if (stringParamSymbol_ < 0)
+            stringParamSymbol_ = InternSymbol(stringParam_.c_str());
+        return stringParamSymbol_;
+    }
+    
     const   vector<double> &GetAcceleratedDeltaValues() { return acceleratedDeltaValues_; }
     void    SetAccelerationValues(const vector<double> &acceleratedDeltaValues) { acceleratedDeltaValues_ = acceleratedDeltaValues; }
     const   vector<int> &GetAcceleratedTickCounts() { return acceleratedTickValues_; }
@@ -638,6 +751,8 @@ public:
     void SetStringParam(const char *stringParam) 
     {
         stringParam_ = stringParam;
+        stringParamSymbol_ = -1;
+        InvalidateUpdate();
         RequestUpdate();
     }
 
@@ -762,7 +877,7 @@ protected:
     CSurfIntegrator *const csi_;
     Navigator *navigator_;
     int slotIndex_;
-    string const name_;
+    int const symbol_; // the name, GetSymbolName has the text
     string const alias_;
     string const sourceFilePath_;
     
@@ -770,6 +885,7 @@ protected:
     
     // these do not own the widgets, ultimately the ControlSurface contains the list of widgets
     vector<Widget *> widgets_;
+    set<Widget *> widgetSet_; // same widgets, for the lookups on the input path
       
     vector<unique_ptr<ActionContext>> emptyContexts_;
     map<Widget *, int> currentActionContextModifiers_;
@@ -781,7 +897,7 @@ protected:
     void UpdateCurrentActionContextModifier(Widget *widget);
     
 public:
-    Zone(CSurfIntegrator *const csi, ZoneManager  *const zoneManager, Navigator *navigator, int slotIndex, const string &name, const string &alias, const string &sourceFilePath): csi_(csi), zoneManager_(zoneManager), navigator_(navigator), slotIndex_(slotIndex), name_(name), alias_(alias), sourceFilePath_(sourceFilePath) {}
+    Zone(CSurfIntegrator *const csi, ZoneManager  *const zoneManager, Navigator *navigator, int slotIndex, const string &name, const string &alias, const string &sourceFilePath): csi_(csi), zoneManager_(zoneManager), navigator_(navigator), slotIndex_(slotIndex), symbol_(InternSymbol(name.c_str())), alias_(alias), sourceFilePath_(sourceFilePath) {}
 
     virtual ~Zone()
     {
@@ -809,11 +925,30 @@ public:
     void DoRelativeAction(Widget *widget, bool &isUsed, double delta);
     void DoRelativeAction(Widget *widget, bool &isUsed, int accelerationIndex, double delta);
     void DoTouch(Widget *widget, const char *widgetName, bool &isUsed, double value);
+    void RunDeferredActions();
     void RequestUpdate();
     const vector<Widget *> &GetWidgets() { return widgets_; }
+    bool GetHasWidget(Widget *widget) { return widgetSet_.count(widget) > 0; }
 
     const char *GetSourceFilePath() { return sourceFilePath_.c_str(); }
     vector<unique_ptr<Zone>> &GetIncludedZones() { return includedZones_; }
+    
+    // whether this zone, one of its included zones or one of its sub zones was loaded from filePath
+    bool GetUsesFile(const filesystem::path &filePath)
+    {
+        if (filesystem::path(sourceFilePath_).lexically_normal() == filePath)
+            return true;
+        
+        for (auto &includedZone : includedZones_)
+            if (includedZone->GetUsesFile(filePath))
+                return true;
+        
+        for (auto &subZone : subZones_)
+            if (subZone->GetUsesFile(filePath))
+                return true;
+        
+        return false;
+    }
 
     Navigator *GetNavigator() { return navigator_; }
     void SetNavigator(Navigator *navigator) {  navigator_ = navigator; }
@@ -830,15 +965,17 @@ public:
 
     const char *GetName()
     {
-        return name_.c_str();
+        return GetSymbolName(symbol_);
     }
     
+    int GetSymbol() { return symbol_; }
+    
     const char *GetAlias()
     {
         if (alias_.size() > 0)
             return alias_.c_str();
         else
-            return name_.c_str();
+            return GetName();
     }
             
     const vector<unique_ptr<ActionContext>> &GetActionContexts(Widget *widget, int modifier)
@@ -857,20 +994,25 @@ public:
             includedZone->Activate();
     }
 
-    void RequestUpdateWidget(Widget *widget)
+    void RunDeferredActionsWidget(Widget *widget)
     {
         for (auto &actionContext : GetActionContexts(widget))
-        {
             actionContext->RunDeferredActions();
+    }
+    
+    void RequestUpdateWidget(Widget *widget)
+    {
+        for (auto &actionContext : GetActionContexts(widget))
             actionContext->RequestUpdate();
-        }
     }
     
     virtual void GoSubZone(const char *subZoneName)
     {
+        int subZoneSymbol = FindSymbol(subZoneName);
+        
         for (auto &subZone : subZones_)
         {
-            if ( ! strcmp(subZone->GetName(), subZoneName))
+            if (subZone->GetSymbol() == subZoneSymbol)
             {
                 subZone->SetSlotIndex(GetSlotIndex());
                 subZone->Activate();
@@ -922,6 +1064,7 @@ public:
     virtual void ForceColorValue(const rgba_color &color) {}
     virtual void ForceUpdateTrackColors() {}
     virtual void RunDeferredActions() {}
+    virtual void SendPendingFeedback() {} // called on every update, for what a processor held back to rate limit it
     virtual void ForceClear() {}
 
     virtual void SetXTouchDisplayColors(const char *colors) {}
@@ -950,6 +1093,18 @@ public:
     }
 };
 
+// Queued sysex goes out highest priority first. Short messages (note/CC LEDs, motor faders, MCU meters)
+// are never queued, these classes are for the devices that drive LEDs, rings and colors with sysex.
+enum SysExPriority
+{
+    SysExPriority_Control = 0, // init strings and other messages that aren't feedback, kept in order
+    SysExPriority_Button,      // button and transport LEDs
+    SysExPriority_Fader,       // rings and other continuous position feedback
+    SysExPriority_Color,
+    SysExPriority_Display,
+    NumSysExPriorities
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class Midi_FeedbackProcessor : public FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -977,6 +1132,12 @@ public:
     { }
     
     virtual const char *GetName() override { return "Midi_FeedbackProcessor"; }
+    
+    // number of leading bytes of a sysex message that address the display or segment it writes, 0 = not tracked by the hardware shadow
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) { return 0; }
+    
+    // which of the device's sysex queues the message waits in, most sysex feedback is display text
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) { return SysExPriority_Display; }
 };
 
 void ReleaseMidiInput(midi_Input *input);
@@ -989,7 +1150,7 @@ class Widget
 protected:
     CSurfIntegrator *const csi_;
     ControlSurface *const surface_;
-    string const name_;
+    int const symbol_; // the name, GetSymbolName has the text
     vector<unique_ptr<FeedbackProcessor>> feedbackProcessors_; // owns the objects
     int channelNumber_ = 0;
     DWORD lastIncomingMessageTime_ = GetTickCount() - 30000;
@@ -1004,9 +1165,13 @@ protected:
 
     bool hasDoublePressActions_ = false;
     
+    double inputArrivalTime_ = 0.0; // latency tracing, arrival of the last input still waiting for its feedback
+    
+    unsigned int writeCount_ = 0; // bumped by everything that can change what the widget shows
+    
 public:
     // all Widgets are owned by their ControlSurface!
-    Widget(CSurfIntegrator *const csi,  ControlSurface *surface, const char *name) : csi_(csi), surface_(surface), name_(name)
+    Widget(CSurfIntegrator *const csi,  ControlSurface *surface, const char *name) : csi_(csi), surface_(surface), symbol_(InternSymbol(name))
     {
         int index = (int)strlen(name) - 1;
         if (isdigit(name[index]))
@@ -1031,7 +1196,9 @@ public:
     void SetHasBeenUsedByUpdate() { hasBeenUsedByUpdate_ = true; }
     bool GetHasBeenUsedByUpdate() { return hasBeenUsedByUpdate_; }
     
-    const char *GetName() { return name_.c_str(); }
+    const char *GetName() { return GetSymbolName(symbol_); }
+    int GetSymbol() { return symbol_; }
+    unsigned int GetWriteCount() { return writeCount_; }
     ControlSurface *GetSurface() { return surface_; }
     ZoneManager *GetZoneManager();
     int GetChannelNumber() { return channelNumber_; }
@@ -1049,12 +1216,16 @@ public:
     
     void SetLastIncomingDelta(double delta) { lastIncomingDelta_ = delta; }
     double GetLastIncomingDelta() { return lastIncomingDelta_; }
+    
+    void SetInputArrivalTime(double arrivalTime) { inputArrivalTime_ = arrivalTime; }
+    LatencyEcho TakeLatencyEcho(); // for the first feedback message after input, travels with it to the port
 
     void Configure(const vector<unique_ptr<ActionContext>> &contexts);
     void UpdateValue(const PropertyList &properties, double value);
     void UpdateValue(const PropertyList &properties, const char * const &value);
     void ForceValue(const PropertyList &properties, const char * const &value);
     void RunDeferredActions();
+    void SendPendingFeedback();
     void UpdateColorValue(const rgba_color &color);
     void SetXTouchDisplayColors(const char *colors);
     void RestoreXTouchDisplayColors();
@@ -1137,6 +1308,7 @@ private:
     void GetWidgetNameAndModifiers(const string &line, string &baseWidgetName, int &modifier, bool &isValueInverted, bool &isFeedbackInverted, bool &hasHoldModifier, bool &HasDoublePressPseudoModifier, bool &isDecrease, bool &isIncrease);
     void GetNavigatorsForZone(const char *zoneName, const char *navigatorName, vector<Navigator *> &navigators);
     void LoadZones(vector<unique_ptr<Zone>> &zones, vector<string> &zoneList);
+    void LoadHomeAndGoZones();
          
     void DoAction(Widget *widget, double value, bool &isUsed);
     void DoRelativeAction(Widget *widget, double delta, bool &isUsed);
@@ -1345,7 +1517,7 @@ private:
     void ReactivateFXMenuZone()
     {
         for (int i = 0; i < goZones_.size(); ++i)
-            if (!strcmp(goZones_[i]->GetName(), "TrackFXMenu") || !strcmp(goZones_[i]->GetName(), "SelectedTrackFXMenu"))
+            if (goZones_[i]->GetSymbol() == CSISymbol_TrackFXMenu || goZones_[i]->GetSymbol() == CSISymbol_SelectedTrackFXMenu)
                 if (goZones_[i]->GetIsActive())
                     goZones_[i]->Activate();
     }
@@ -1367,6 +1539,7 @@ public:
     }
     
     void Initialize();
+    void ReloadZoneFile(const filesystem::path &filePath);
     
     Navigator *GetNavigatorForTrack(MediaTrack* track);
     Navigator *GetMasterTrackNavigator();
@@ -1418,6 +1591,7 @@ public:
     bool GetIsLastTouchedFXParamMappingEnabled() { return isLastTouchedFXParamMappingEnabled_; }
     
     Zone *GetLearnedFocusedFXZone() { return  learnFocusedFXZone_.get();  }
+    bool GetIsLearning() { return learnFocusedFXZone_ != NULL; } // only while the Learn window is open
     
     const vector<unique_ptr<ActionContext>> &GetLearnFocusedFXActionContexts(Widget *widget, int modifier)
     {
@@ -1537,14 +1711,16 @@ public:
         ClearFXMapping();
         ResetOffsets();
         
+        int zoneSymbol = FindSymbol(zoneName);
+        
         for (int i = 0; i < goZones_.size(); ++i)
         {
-            if (!strcmp(zoneName, goZones_[i]->GetName()))
+            if (zoneSymbol == goZones_[i]->GetSymbol())
             {
                 if (goZones_[i]->GetIsActive())
                 {
                     for (int j = i; j < goZones_.size(); ++j)
-                        if (!strcmp(zoneName, goZones_[j]->GetName()))
+                        if (zoneSymbol == goZones_[j]->GetSymbol())
                             goZones_[j]->Deactivate();
                     
                     return;
@@ -1553,14 +1729,14 @@ public:
         }
         
         for (auto &goZone : goZones_)
-            if (strcmp(zoneName, goZone->GetName()))
+            if (zoneSymbol != goZone->GetSymbol())
                 goZone->Deactivate();
         
         for (auto &goZone : goZones_)
-            if (!strcmp(zoneName, goZone->GetName()))
+            if (zoneSymbol == goZone->GetSymbol())
                goZone->Activate();
         
-        if ( ! strcmp(zoneName, "SelectedTrackFX"))
+        if (zoneSymbol == CSISymbol_SelectedTrackFX)
             GoSelectedTrackFX();
     }
     
@@ -1568,14 +1744,13 @@ public:
     {
         if (! GetIsBroadcaster() && ! GetIsListener()) // No Broadcasters/Listeners relationships defined
         {
-            if (!strcmp("LastTouchedFXParam", zoneName))
-                ClearLastTouchedFXParam();
-            else if (!strcmp("FocusedFX", zoneName))
-                ClearFocusedFX();
-            else if (!strcmp("SelectedTrackFX", zoneName))
-                ClearSelectedTrackFX();
-            else if (!strcmp("FXSlot", zoneName))
-                ClearFXSlot();
+            switch (FindSymbol(zoneName))
+            {
+                case CSISymbol_LastTouchedFXParam: ClearLastTouchedFXParam(); break;
+                case CSISymbol_FocusedFX: ClearFocusedFX(); break;
+                case CSISymbol_SelectedTrackFX: ClearSelectedTrackFX(); break;
+                case CSISymbol_FXSlot: ClearFXSlot(); break;
+            }
         }
         else
             for (auto &listener : listeners_)
@@ -1665,10 +1840,12 @@ public:
         
         for (auto &goZone : goZones_)
         {
-            if (!strcmp(goZone->GetName(), "SelectedTrack") ||
-                !strcmp(goZone->GetName(), "SelectedTrackSend") ||
-                !strcmp(goZone->GetName(), "SelectedTrackReceive") ||
-                !strcmp(goZone->GetName(), "SelectedTrackFXMenu"))
+            int symbol = goZone->GetSymbol();
+            
+            if (symbol == CSISymbol_SelectedTrack ||
+                symbol == CSISymbol_SelectedTrackSend ||
+                symbol == CSISymbol_SelectedTrackReceive ||
+                symbol == CSISymbol_SelectedTrackFXMenu)
             {
                 goZone->Deactivate();
             }
@@ -1706,9 +1883,14 @@ public:
     }
     
     bool GetIsGoZoneActive(const char *zoneName)
+    {
+        return GetIsGoZoneActive(FindSymbol(zoneName));
+    }
+    
+    bool GetIsGoZoneActive(int zoneSymbol)
     {
         for (auto &goZone : goZones_)
-            if (!strcmp(zoneName, goZone->GetName()))
+            if (zoneSymbol == goZone->GetSymbol())
                 return goZone->GetIsActive();
         
         return false;
@@ -1723,6 +1905,60 @@ public:
         return true;
     }
 
+    struct ProjectState
+    {
+        vector<int> activeGoZones; // symbols
+        int trackSendOffset = 0;
+        int trackReceiveOffset = 0;
+        int trackFXMenuOffset = 0;
+        int selectedTrackSendOffset = 0;
+        int selectedTrackReceiveOffset = 0;
+        int selectedTrackFXMenuOffset = 0;
+        int masterTrackFXMenuOffset = 0;
+    };
+
+    void SaveProjectState(ProjectState &state)
+    {
+        state.activeGoZones.clear();
+
+        for (auto &goZone : goZones_)
+            if (goZone->GetIsActive() && find(state.activeGoZones.begin(), state.activeGoZones.end(), goZone->GetSymbol()) == state.activeGoZones.end())
+                state.activeGoZones.push_back(goZone->GetSymbol());
+
+        state.trackSendOffset = trackSendOffset_;
+        state.trackReceiveOffset = trackReceiveOffset_;
+        state.trackFXMenuOffset = trackFXMenuOffset_;
+        state.selectedTrackSendOffset = selectedTrackSendOffset_;
+        state.selectedTrackReceiveOffset = selectedTrackReceiveOffset_;
+        state.selectedTrackFXMenuOffset = selectedTrackFXMenuOffset_;
+        state.masterTrackFXMenuOffset = masterTrackFXMenuOffset_;
+    }
+
+    // Unlike GoZone/GoHome this does not touch the REAPER UI, it only swaps which zones are live
+    void RestoreProjectState(const ProjectState &state)
+    {
+        ClearFXMapping();
+
+        for (auto &goZone : goZones_)
+            if (find(state.activeGoZones.begin(), state.activeGoZones.end(), goZone->GetSymbol()) == state.activeGoZones.end())
+                goZone->Deactivate();
+
+        for (auto &goZone : goZones_)
+            if (find(state.activeGoZones.begin(), state.activeGoZones.end(), goZone->GetSymbol()) != state.activeGoZones.end() && ! goZone->GetIsActive())
+                goZone->Activate();
+
+        if (find(state.activeGoZones.begin(), state.activeGoZones.end(), (int)CSISymbol_SelectedTrackFX) != state.activeGoZones.end())
+            GoSelectedTrackFX();
+
+        trackSendOffset_ = state.trackSendOffset;
+        trackReceiveOffset_ = state.trackReceiveOffset;
+        trackFXMenuOffset_ = state.trackFXMenuOffset;
+        selectedTrackSendOffset_ = state.selectedTrackSendOffset;
+        selectedTrackReceiveOffset_ = state.selectedTrackReceiveOffset;
+        selectedTrackFXMenuOffset_ = state.selectedTrackFXMenuOffset;
+        masterTrackFXMenuOffset_ = state.masterTrackFXMenuOffset;
+    }
+
     void ClearFXMapping()
     {
         ClearLearnFocusedFXZone();
@@ -1732,22 +1968,18 @@ public:
         ClearFXSlot();
     }
         
-    void AdjustBank(const char *zoneName, int amount)
+    void AdjustZoneBank(int zoneSymbol, int amount)
     {
-        if (!strcmp(zoneName, "TrackSend"))
-            AdjustBank(trackSendOffset_, amount);
-        else if (!strcmp(zoneName, "TrackReceive"))
-            AdjustBank(trackReceiveOffset_, amount);
-        else if (!strcmp(zoneName, "TrackFXMenu"))
-            AdjustBank(trackFXMenuOffset_, amount);
-        else if (!strcmp(zoneName, "SelectedTrackSend"))
-            AdjustBank(selectedTrackSendOffset_, amount);
-        else if (!strcmp(zoneName, "SelectedTrackReceive"))
-            AdjustBank(selectedTrackReceiveOffset_, amount);
-        else if (!strcmp(zoneName, "SelectedTrackFXMenu"))
-            AdjustBank(selectedTrackFXMenuOffset_, amount);
-        else if (!strcmp(zoneName, "MasterTrackFXMenu"))
-            AdjustBank(masterTrackFXMenuOffset_, amount);
+        switch (zoneSymbol)
+        {
+            case CSISymbol_TrackSend: AdjustBank(trackSendOffset_, amount); break;
+            case CSISymbol_TrackReceive: AdjustBank(trackReceiveOffset_, amount); break;
+            case CSISymbol_TrackFXMenu: AdjustBank(trackFXMenuOffset_, amount); break;
+            case CSISymbol_SelectedTrackSend: AdjustBank(selectedTrackSendOffset_, amount); break;
+            case CSISymbol_SelectedTrackReceive: AdjustBank(selectedTrackReceiveOffset_, amount); break;
+            case CSISymbol_SelectedTrackFXMenu: AdjustBank(selectedTrackFXMenuOffset_, amount); break;
+            case CSISymbol_MasterTrackFXMenu: AdjustBank(masterTrackFXMenuOffset_, amount); break;
+        }
     }
                 
     void AddZoneFilePath(const string &name, CSIZoneInfo &zoneInfo)
@@ -1762,15 +1994,37 @@ public:
         }
     }
 
+    // the same zones, in the same order, as RequestUpdate
+    void RunDeferredActions()
+    {
+        if (learnFocusedFXZone_ != NULL)
+            learnFocusedFXZone_->RunDeferredActions();
+
+        if (lastTouchedFXParamZone_ != NULL && isLastTouchedFXParamMappingEnabled_)
+            lastTouchedFXParamZone_->RunDeferredActions();
+
+        if (focusedFXZone_ != NULL)
+            focusedFXZone_->RunDeferredActions();
+        
+        for (int i = 0; i < selectedTrackFXZones_.size(); ++i)
+            selectedTrackFXZones_[i]->RunDeferredActions();
+        
+        if (fxSlotZone_ != NULL)
+            fxSlotZone_->RunDeferredActions();
+        
+        for (int i = 0; i < goZones_.size(); ++i)
+            goZones_[i]->RunDeferredActions();
+
+        if (homeZone_ != NULL)
+            homeZone_->RunDeferredActions();
+    }
+    
     void RequestUpdate()
     {
         CheckFocusedFXState();
           
         if (learnFocusedFXZone_ != NULL)
-        {
-            UpdateLearnWindow(this);
             learnFocusedFXZone_->RequestUpdate();
-        }
 
         if (lastTouchedFXParamZone_ != NULL && isLastTouchedFXParamMappingEnabled_)
             lastTouchedFXParamZone_->RequestUpdate();
@@ -1801,11 +2055,28 @@ class CSIMessageGenerator
 protected:
     CSurfIntegrator *const csi_;
     Widget  *const widget_;
+    int oscAddressSymbol_ = CSISymbol_None;
+    DWORD lastDispatchTime_ = 0;
     
 public:
     CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : csi_(csi), widget_(widget) {}
     virtual ~CSIMessageGenerator() {}
     
+    Widget *GetWidget() { return widget_; }
+    
+    // true when each message carries the full control position (faders), so only the latest one in an input batch matters
+    virtual bool GetIsAbsolute() { return false; }
+    
+    // called with each OSC value as it's read, before the batch is coalesced
+    virtual void AddInputValue(double value) {}
+    
+    // the OSC address it listens to, interned once when the widget is built so reading input doesn't have to
+    int GetOSCAddressSymbol() { return oscAddressSymbol_; }
+    void SetOSCAddressSymbol(int symbol) { oscAddressSymbol_ = symbol; }
+    
+    DWORD GetLastDispatchTime() { return lastDispatchTime_; }
+    void SetLastDispatchTime(DWORD time) { lastDispatchTime_ = time; }
+    
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) {}
     virtual void ProcessMessage(double value)
     {
@@ -2016,6 +2287,16 @@ public:
         return modifierValue;
     }
 
+    int GetModifierValue()
+    {
+        int modifierValue = 0;
+        for (int i = 0; i < MaxModifiers; ++i)
+            if (modifiers_[i].isEngaged)
+                modifierValue |= maskFromModifier((Modifiers)i);
+
+        return modifierValue;
+    }
+
     void SetModifierValue(int value)
     {
         for (int i = 0; i < MaxModifiers; ++i)
@@ -2127,6 +2408,147 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class LatencyHistogram
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    static const int NumBuckets = 10;
+    
+    int counts_[NumBuckets] = {};
+    int total_ = 0;
+    double sum_ = 0.0;
+    double max_ = 0.0;
+    
+    static int GetBucketLimit(int index) // upper bound in ms, the last bucket is open ended
+    {
+        static const int s_bucketLimits[NumBuckets] = { 1, 2, 5, 10, 20, 35, 50, 100, 250, 0 };
+        return s_bucketLimits[index];
+    }
+    
+public:
+    void Add(double ms)
+    {
+        int index = 0;
+        while (index < NumBuckets - 1 && ms >= GetBucketLimit(index))
+            index++;
+        
+        counts_[index]++;
+        total_++;
+        sum_ += ms;
+        if (ms > max_)
+            max_ = ms;
+    }
+    
+    int GetTotal() { return total_; }
+    
+    void Clear()
+    {
+        memset(counts_, 0, sizeof(counts_));
+        total_ = 0;
+        sum_ = 0.0;
+        max_ = 0.0;
+    }
+    
+    void Log(const char *surfaceName, const char *stage)
+    {
+        if (total_ == 0)
+            return;
+        
+        char buf[MEDBUF];
+        snprintf(buf, sizeof(buf), "%s %s: n=%d avg=%.2fms max=%.2fms |", surfaceName, stage, total_, sum_ / total_, max_);
+        
+        for (int i = 0; i < NumBuckets; ++i)
+        {
+            if (i < NumBuckets - 1)
+                snprintf_append(buf, sizeof(buf), " <%d:%d", GetBucketLimit(i), counts_[i]);
+            else
+                snprintf_append(buf, sizeof(buf), " >=%d:%d", GetBucketLimit(i - 1), counts_[i]);
+        }
+        
+        LogToConsole(MEDBUF, "%s\n", buf);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class LatencyTrace
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // All times are time_precise() seconds, histograms are in ms. Arrival is stamped by the surface IO as it takes
+    // the input from the device: MIDI from the event's offset into the span since the previous read, OSC when the
+    // packet comes off the socket (UDP keeps no arrival time).
+    // poll:     interval between input reads, i.e. the worst case wait imposed by the Run cadence
+    // dispatch: input arrival -> zone dispatch and REAPER write done
+    // echo:     input arrival -> first feedback message for the widget that was moved going out to the port, of any
+    //           kind (short MIDI, sysex, OSC), after the hardware shadow, bank frames and output queues
+private:
+    LatencyHistogram poll_;
+    LatencyHistogram dispatch_;
+    LatencyHistogram echo_;
+    
+    double lastPollTime_ = 0.0;
+    double lastReportTime_ = 0.0;
+    
+    static const int ReportInterval = 5; // seconds
+    
+public:
+    static const int MaxEchoWait = 1; // seconds, longer waits are touch suppressed feedback and are not counted
+    
+    void InputPolled(double now)
+    {
+        if (lastPollTime_ != 0.0)
+            poll_.Add((now - lastPollTime_) * 1000.0);
+        
+        lastPollTime_ = now;
+    }
+    
+    void InputDispatched(double arrivalTime) { dispatch_.Add((time_precise() - arrivalTime) * 1000.0); }
+    void FeedbackEchoed(double arrivalTime) { echo_.Add((time_precise() - arrivalTime) * 1000.0); }
+    
+    void Report(const char *surfaceName)
+    {
+        double now = time_precise();
+        
+        if (lastReportTime_ == 0.0)
+            lastReportTime_ = now;
+        
+        if (now - lastReportTime_ < ReportInterval)
+            return;
+        
+        lastReportTime_ = now;
+        
+        if (dispatch_.GetTotal() == 0 && echo_.GetTotal() == 0)
+        {
+            poll_.Clear();
+            return;
+        }
+        
+        poll_.Log(surfaceName, "poll");
+        dispatch_.Log(surfaceName, "dispatch");
+        echo_.Log(surfaceName, "echo");
+        
+        poll_.Clear();
+        dispatch_.Clear();
+        echo_.Clear();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct LatencyEcho
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Carried with a feedback message through the surface IO's shadow, frames and queues, recorded when it's sent.
+    // Empty unless the message answers input and the latency display is on.
+    LatencyTrace *trace = NULL;
+    double arrivalTime = 0.0;
+    
+    void Record() const
+    {
+        if (trace != NULL && time_precise() - arrivalTime < LatencyTrace::MaxEchoWait)
+            trace->FeedbackEchoed(arrivalTime);
+    }
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 struct ChannelTouch
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2183,11 +2605,15 @@ protected:
     map<const string, vector<double>> accelerationValues_;
     vector<double> emptyAccelerationValues_;
     
+    int motorFaderMinInterval_ = 0; // ms, 0 = send every change
+    double motorFaderMinDelta_ = 0.0; // normalized, 0 = send every change
+    
     void ProcessValues(const vector<vector<string>> &lines);
     
     CSurfIntegrator *const csi_;
     Page *const page_;
     string const name_;
+    int const symbol_;
     unique_ptr<ZoneManager> zoneManager_;
     unique_ptr<ModifierManager> modifierManager_;
     
@@ -2198,11 +2624,85 @@ protected:
 
     vector<Widget *> widgets_; // owns list
     map<const string, unique_ptr<Widget>> widgetsByName_;
+    map<int, Widget *> widgetsBySymbol_;
     map<const string, unique_ptr<CSIMessageGenerator>> CSIMessageGeneratorsByMessage_;
+    
+    vector<CSIMessageGenerator *> inputGenerators_; // generator for each message of the current input batch, NULL if unmapped
+    vector<double> inputArrivalTimes_; // and its arrival, 0 when not tracing
+
+    static const int FaderDispatchInterval = 15; // ms, between Runs a fader is written to REAPER at most this often
+    
+    // Between Runs an absolute value (a fader move) read sooner than FaderDispatchInterval after the last one dispatched
+    // for its generator is parked instead. The I/O timer dispatches the latest parked value once the interval is up,
+    // Run dispatches whatever is still parked, and a bank or page change drops them.
+    bool GetShouldParkInput(CSIMessageGenerator *generator, DWORD now);
+    bool GetIsParkedInputDue(CSIMessageGenerator *generator, DWORD now);
+    virtual void ClearParkedInput() {}
+    
+    bool GetIsSupersededInBatch(int index)
+    {
+        // an absolute value is dropped only if the same generator sends again later in the batch,
+        // with no other message for that widget (e.g. a touch release) in between
+        CSIMessageGenerator *generator = inputGenerators_[index];
+        
+        if (generator == NULL || ! generator->GetIsAbsolute())
+            return false;
+        
+        for (int i = index + 1; i < (int)inputGenerators_.size(); ++i)
+        {
+            if (inputGenerators_[i] == generator)
+                return true;
+            else if (inputGenerators_[i] != NULL && inputGenerators_[i]->GetWidget() == generator->GetWidget())
+                return false;
+        }
+        
+        return false;
+    }
 
     bool speedX5_ = false;
+    
+    bool isBankTransitionPending_ = false;
+    bool isPageEnterPending_ = false;
+    
+    // Called by the subclasses between their IO's BeginFrame and EndFrame. After a page enter every widget is
+    // cleared first, which makes it send again: each control gets the new page's state or its clear, once, and
+    // EndFrame's check against the hardware shadow drops whatever the outgoing page already left on the device.
+    void RequestBankTransitionUpdate()
+    {
+        if (isPageEnterPending_)
+        {
+            isPageEnterPending_ = false;
+            
+            for (auto widget : widgets_)
+                widget->ForceClear();
+        }
+        
+        ControlSurface::RequestUpdate();
+    }
+    
+    LatencyTrace latencyTrace_;
+
+    void BeginInputBatch()
+    {
+        if (g_surfaceLatencyDisplay)
+            latencyTrace_.InputPolled(time_precise());
+    }
+    
+    void BeginInputDispatch(CSIMessageGenerator *generator, double arrivalTime)
+    {
+        generator->SetLastDispatchTime(GetTickCount());
+        
+        if (arrivalTime != 0.0)
+            generator->GetWidget()->SetInputArrivalTime(arrivalTime);
+    }
+    
+    void EndInputDispatch(CSIMessageGenerator *generator, double arrivalTime)
+    {
+        if (arrivalTime != 0.0)
+            latencyTrace_.InputDispatched(arrivalTime);
+    }
 
-    ControlSurface(CSurfIntegrator *const csi, Page *page, const string &name, int numChannels, int channelOffset) : csi_(csi), page_(page), name_(name), numChannels_(numChannels), channelOffset_(channelOffset), modifierManager_(make_unique<ModifierManager>(csi_, (Page *)NULL, this))
+    ControlSurface(CSurfIntegrator *const csi, Page *page, const string &name, int numChannels, int channelOffset) : csi_(csi), page_(page), name_(name), symbol_(InternSymbol(name.c_str())), numChannels_(numChannels), channelOffset_(channelOffset), modifierManager_(make_unique<ModifierManager>(csi_, (Page *)NULL, this))
     {
         int size = 0;
         scrubModePtr_ = (int*)get_config_var("scrubmode", &size);
@@ -2264,16 +2764,18 @@ protected:
         AddWidget(surface, "OnZoneDeactivation");
     }
     
-    void DoWidgetAction(const string &widgetName)
+    void DoWidgetAction(int widgetSymbol)
     {
-        if (widgetsByName_.count(widgetName) > 0)
-            zoneManager_->DoAction(widgetsByName_[widgetName].get(), 1.0);
+        auto it = widgetsBySymbol_.find(widgetSymbol);
+        if (it != widgetsBySymbol_.end())
+            zoneManager_->DoAction(it->second, 1.0);
     }
     
 public:
     virtual ~ControlSurface()
     {
         widgets_.clear();
+        widgetsBySymbol_.clear();
         widgetsByName_.clear();
         CSIMessageGeneratorsByMessage_.clear();
     }
@@ -2309,14 +2811,16 @@ public:
     void ClearModifiers();
     void ClearModifier(const char *modifier);
         
+    void RunDeferredActions();
     virtual void RequestUpdate();
     void ForceClearTrack(int trackNum);
     void UpdateTrackColors();
     void OnTrackSelection(MediaTrack *track);
-    virtual void SendOSCMessage(const char *zoneName) {}
-    virtual void SendOSCMessage(const char *zoneName, int value) {}
-    virtual void SendOSCMessage(const char *zoneName, double value) {}
-    virtual void SendOSCMessage(const char *zoneName, const char *value) {}
+    // addressSymbol is what the trace records as the address, interned once by the zone or action sending it
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol) {}
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, int value) {}
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, double value) {}
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, const char *value) {}
 
     virtual void HandleExternalInput() {}
     virtual void UpdateTimeDisplay() {}
@@ -2329,6 +2833,8 @@ public:
     ZoneManager *GetZoneManager() { return zoneManager_.get(); }
     Page *GetPage() { return page_; }
     const char *GetName() { return name_.c_str(); }
+    int GetSymbol() { return symbol_; }
+    LatencyTrace &GetLatencyTrace() { return latencyTrace_; }
     
     int GetNumChannels() { return numChannels_; }
     int GetChannelOffset() { return channelOffset_; }
@@ -2351,12 +2857,41 @@ public:
     void SetDoublePressTime(int doublePressTime) { doublePressTime_ = doublePressTime; }
     int GetDoublePressTime() { return doublePressTime_; }
 
+    void BeginBankTransition()
+    {
+        isBankTransitionPending_ = true;
+        ClearParkedInput(); // fader moves meant for the tracks that were banked away
+    }
+
     void UpdateCurrentActionContextModifiers()
     {
         if (! usesLocalModifiers_)
             GetZoneManager()->UpdateCurrentActionContextModifiers();
     }
-    
+
+    struct ProjectState
+    {
+        ZoneManager::ProjectState zoneState;
+        int modifierValue = 0;
+    };
+
+    void SaveProjectState(ProjectState &state)
+    {
+        zoneManager_->SaveProjectState(state.zoneState);
+        state.modifierValue = modifierManager_->GetModifierValue();
+    }
+
+    void RestoreProjectState(const ProjectState &state)
+    {
+        CancelRewindAndFastForward();
+        modifierManager_->SetModifierValue(state.modifierValue);
+        modifierManager_->RecalculateModifiers();
+        zoneManager_->RestoreProjectState(state.zoneState);
+    }
+
+    int GetMotorFaderMinInterval() { return motorFaderMinInterval_; }
+    double GetMotorFaderMinDelta() { return motorFaderMinDelta_; }
+
     double GetStepSize(const char * const widgetClass)
     {
         if (stepSize_.find(widgetClass) != stepSize_.end())
@@ -2491,18 +3026,18 @@ public:
 
     void HandleStop()
     {
-        DoWidgetAction("OnRecordStop");
-        DoWidgetAction("OnPlayStop");
+        DoWidgetAction(CSISymbol_OnRecordStop);
+        DoWidgetAction(CSISymbol_OnPlayStop);
     }
     
     void HandlePlay()
     {
-        DoWidgetAction("OnPlayStart");
+        DoWidgetAction(CSISymbol_OnPlayStart);
     }
     
     void HandleRecord()
     {
-        DoWidgetAction("OnRecordStart");
+        DoWidgetAction(CSISymbol_OnRecordStart);
     }
         
     void StartRewinding()
@@ -2556,7 +3091,11 @@ public:
             widgetsByName_.insert(make_pair(widgetName, make_unique<Widget>(csi_, surface, widgetName)));
             
             if (widgetsByName_.count(widgetName) > 0)
-                widgets_.push_back(GetWidgetByName(widgetName));
+            {
+                Widget *widget = GetWidgetByName(widgetName);
+                widgets_.push_back(widget);
+                widgetsBySymbol_[widget->GetSymbol()] = widget;
+            }
         }
     }
 
@@ -2570,21 +3109,23 @@ public:
 
     void OnPageEnter()
     {
-        ForceClear();
-        
-        DoWidgetAction("OnPageEnter");
+        // The outgoing page leaves the hardware as it is, the new page's first update is a bank transition
+        // frame that sends only what differs from it, see RequestBankTransitionUpdate.
+        isPageEnterPending_ = true;
+        BeginBankTransition();
+
+        DoWidgetAction(CSISymbol_OnPageEnter);
     }
     
     void OnPageLeave()
     {
-        ForceClear();
-        
-        DoWidgetAction("OnPageLeave");
+        ClearParkedInput();
+        DoWidgetAction(CSISymbol_OnPageLeave);
     }
     
     void OnInitialization()
     {
-        DoWidgetAction("OnInitialization");
+        DoWidgetAction(CSISymbol_OnInitialization);
     }
 };
 
@@ -2595,25 +3136,242 @@ class Midi_ControlSurfaceIO
 protected:
     CSurfIntegrator *const csi_;
     string const name_;
+    int const symbol_; // same name, and so the same symbol, as the surfaces on this device
     int const channelCount_;
     midi_Input *const midiInput_;
     midi_Output *const midiOutput_;
-    WDL_Queue messageQueue_;
     const int maxMesssagesPerRun_;
+    double lastSwapTime_ = 0.0; // time_precise() of the last input read, the read buffer's frame offsets count from it
     
-    void SendMidiSysexMessage(MIDI_event_ex_t *midiMessage)
-    {
-        if (midiOutput_)
-            midiOutput_->SendMsg(midiMessage, -1);
-    }
-
-public:
-    Midi_ControlSurfaceIO(CSurfIntegrator *csi, const char *name, int channelCount, midi_Input *midiInput, midi_Output *midiOutput, int surfaceRefreshRate, int maxMesssagesPerRun) : csi_(csi), name_(name), channelCount_(channelCount), midiInput_(midiInput), midiOutput_(midiOutput), surfaceRefreshRate_(surfaceRefreshRate), maxMesssagesPerRun_(maxMesssagesPerRun) {}
-
-    ~Midi_ControlSurfaceIO()
+    // MaxMIDIBytesPerSecond in CSI.ini, 0 or absent = no byte budget. Run spends at most a refresh period's worth
+    // of it on queued messages. 3125 is DIN MIDI (31250 baud at 10 bits a byte), which suits USB devices that
+    // forward to a DIN-speed controller internally, full speed USB MIDI doesn't need it.
+    const int maxBytesPerSecond_;
+    
+    /////////////////////////////////////////////////////////////////////////////
+    struct QueuedSysExMessage
+    /////////////////////////////////////////////////////////////////////////////
     {
-        if (midiInput_) ReleaseMidiInput(midiInput_);
-        if (midiOutput_) ReleaseMidiOutput(midiOutput_);
+        unsigned long long target; // 0 = never superseded
+        string data;
+        LatencyEcho echo;
+    };
+    
+    deque<QueuedSysExMessage> sysExQueues_[NumSysExPriorities];
+    set<unsigned long long> queuedTargets_;
+    bool isStagingFrame_ = false;
+    
+    /////////////////////////////////////////////////////////////////////////////
+    struct FrameMessage
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        unsigned long long target; // 0 = never superseded
+        int offset;
+        int size;
+        bool isFeedback;
+        int sysExAddressSize;
+        SysExPriority priority;
+        LatencyEcho echo;
+    };
+    
+    vector<FrameMessage> frameMessages_;
+    vector<unsigned char> frameData_;
+    
+    // Hardware shadow -- what the device shows, as far as we know. The device is shared by every page's surface,
+    // so this lives here rather than in the surfaces. Feedback that matches it is not sent again.
+    static const int NumShortMessageShadowEntries = 5 * 16 * 128;
+    vector<int> shortMessageShadow_; // see GetShortMessageShadowIndex, 0 = unknown
+    map<const string, string> sysExShadow_; // address bytes -> full message
+    
+    // note/CC/pitch bend messages address a physical control by status and first data byte, channel pressure (MCU meters) is a stream
+    static int GetShortMessageShadowIndex(int first, int second)
+    {
+        int type = 0;
+        
+        switch (first & 0xf0)
+        {
+            case 0x80:
+            case 0x90: type = 0; break;
+            case 0xa0: type = 1; break;
+            case 0xb0: type = 2; break;
+            case 0xc0: type = 3; second = 0; break;
+            case 0xe0: type = 4; second = 0; break;
+            default: return -1;
+        }
+        
+        return (((type << 4) | (first & 0x0f)) << 7) | (second & 0x7f);
+    }
+    
+    // returns false if the device already shows this message
+    bool UpdateShortMessageShadow(int first, int second, int third)
+    {
+        const int index = GetShortMessageShadowIndex(first, second);
+        if (index < 0)
+            return true;
+        
+        const int message = 0x1000000 | (first << 16) | (second << 8) | third;
+        if (shortMessageShadow_[index] == message)
+            return false;
+        
+        shortMessageShadow_[index] = message;
+        return true;
+    }
+    
+    // returns false if the device already shows this message, sysExAddressSize 0 = not tracked
+    bool UpdateSysExShadow(const unsigned char *data, int size, int sysExAddressSize)
+    {
+        if (sysExAddressSize <= 0 || sysExAddressSize >= size)
+            return true;
+        
+        string &shown = sysExShadow_[string((const char *)data, sysExAddressSize)];
+        if (shown.size() == size && ! memcmp(shown.data(), data, size))
+            return false;
+        
+        shown.assign((const char *)data, size);
+        return true;
+    }
+    
+    static unsigned long long GetShortMessageTarget(int first, int second)
+    {
+        const int index = GetShortMessageShadowIndex(first, second);
+        return index < 0 ? 0 : 0x1000000 | index;
+    }
+    
+    // a sysex message is identified by its address bytes, or failing that by the feedback processor that sent it plus its header
+    static unsigned long long GetSysExTarget(const Midi_FeedbackProcessor *processor, const MIDI_event_ex_t *midiMessage, int sysExAddressSize)
+    {
+        if (processor == NULL)
+            return 0;
+        
+        unsigned long long key = sysExAddressSize > 0 ? 0 : (unsigned long long)(UINT_PTR)processor;
+        const int headerSize = sysExAddressSize > 0 ? sysExAddressSize : 7;
+        
+        for (int i = 0; i < midiMessage->size && i < headerSize; ++i)
+            key = key * 131 + midiMessage->midi_message[i];
+        
+        return key | (1ULL << 63);
+    }
+    
+    void AddFrameMessage(unsigned long long target, const unsigned char *data, int size, bool isFeedback, int sysExAddressSize, SysExPriority priority, const LatencyEcho &echo)
+    {
+        FrameMessage message;
+        message.target = target;
+        message.offset = (int)frameData_.size();
+        message.size = size;
+        message.isFeedback = isFeedback;
+        message.sysExAddressSize = sysExAddressSize;
+        message.priority = priority;
+        message.echo = echo;
+        
+        frameMessages_.push_back(message);
+        frameData_.insert(frameData_.end(), data, data + size);
+    }
+    
+    // only a known target is safe to supersede on, the newer content takes the older message's place in the queue
+    void AddQueuedMessage(SysExPriority priority, unsigned long long target, const unsigned char *data, int size, const LatencyEcho &echo)
+    {
+        if (target != 0 && queuedTargets_.count(target) > 0)
+        {
+            for (auto &queue : sysExQueues_)
+            {
+                for (auto &queued : queue)
+                {
+                    if (queued.target == target)
+                    {
+                        queued.data.assign((const char *)data, size);
+                        
+                        if (echo.trace != NULL)
+                            queued.echo = echo;
+                        
+                        return;
+                    }
+                }
+            }
+        }
+        
+        QueuedSysExMessage message;
+        message.target = target;
+        message.data.assign((const char *)data, size);
+        message.echo = echo;
+        sysExQueues_[priority].push_back(message);
+        
+        if (target != 0)
+            queuedTargets_.insert(target);
+    }
+    
+    // the trace records output here, where it goes to the port, after the shadow and the queues had their say
+    void SendMidiSysexMessage(MIDI_event_ex_t *midiMessage, const LatencyEcho &echo)
+    {
+        g_traceRing.Record(TraceEvent_SysExOut, symbol_, 0, midiMessage->size, midiMessage->midi_message);
+        
+        if (midiOutput_)
+            midiOutput_->SendMsg(midiMessage, -1);
+        
+        echo.Record();
+    }
+    
+    void SendShortMessage(int first, int second, int third, const LatencyEcho &echo)
+    {
+        const unsigned char bytes[3] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
+        g_traceRing.Record(TraceEvent_MidiOut, symbol_, 0, 0.0, bytes);
+        
+        if (midiOutput_)
+            midiOutput_->Send(first, second, third, -1);
+        
+        echo.Record();
+    }
+
+    deque<QueuedSysExMessage> *GetNextQueue()
+    {
+        for (auto &queue : sysExQueues_)
+            if ( ! queue.empty())
+                return &queue;
+        
+        return NULL;
+    }
+    
+    bool SendNextQueuedMessage()
+    {
+        deque<QueuedSysExMessage> *queue = GetNextQueue();
+        if (queue == NULL)
+            return false;
+        
+        const QueuedSysExMessage &message = queue->front();
+        
+        struct
+        {
+            MIDI_event_ex_t evt;
+            char data[256];
+        } midiSysExData;
+
+        midiSysExData.evt.frame_offset = 0;
+        midiSysExData.evt.size = (int)message.data.size();
+        memcpy(midiSysExData.evt.midi_message, message.data.data(), message.data.size());
+        
+        LatencyEcho echo = message.echo;
+        
+        if (message.target != 0)
+            queuedTargets_.erase(message.target);
+        queue->pop_front();
+        
+        if (midiSysExData.evt.size == 3 && midiSysExData.evt.midi_message[0] != 0xf0) // a short message from a bank transition frame
+            SendShortMessage(midiSysExData.evt.midi_message[0], midiSysExData.evt.midi_message[1], midiSysExData.evt.midi_message[2], echo);
+        else
+            SendMidiSysexMessage(&midiSysExData.evt, echo);
+        
+        return true;
+    }
+
+public:
+    Midi_ControlSurfaceIO(CSurfIntegrator *csi, const char *name, int channelCount, midi_Input *midiInput, midi_Output *midiOutput, int surfaceRefreshRate, int maxMesssagesPerRun, int maxBytesPerSecond) : csi_(csi), name_(name), symbol_(InternSymbol(name)), channelCount_(channelCount), midiInput_(midiInput), midiOutput_(midiOutput), maxMesssagesPerRun_(maxMesssagesPerRun), maxBytesPerSecond_(maxBytesPerSecond), surfaceRefreshRate_(surfaceRefreshRate)
+    {
+        InvalidateShadow();
+    }
+
+    ~Midi_ControlSurfaceIO()
+    {
+        if (midiInput_) ReleaseMidiInput(midiInput_);
+        if (midiOutput_) ReleaseMidiOutput(midiOutput_);
     }
     
     int surfaceRefreshRate_;
@@ -2624,71 +3382,161 @@ public:
 
     void HandleExternalInput(Midi_ControlSurface *surface);
     
-    void QueueMidiSysExMessage(MIDI_event_ex_t *midiMessage)
+    void InvalidateShadow()
+    {
+        shortMessageShadow_.assign(NumShortMessageShadowEntries, 0);
+        sysExShadow_.clear();
+    }
+    
+    // the control was touched or moved, whatever it shows now is up to the device
+    void InvalidateShadow(const MIDI_event_ex_t *evt)
+    {
+        if (evt->size <= 3)
+        {
+            const int index = GetShortMessageShadowIndex(evt->midi_message[0], evt->midi_message[1]);
+            if (index >= 0)
+                shortMessageShadow_[index] = 0;
+        }
+    }
+    
+    // processor is NULL for messages that don't come from feedback (init strings, actions), their effect on the device is unknown
+    void QueueMidiSysExMessage(MIDI_event_ex_t *midiMessage, Midi_FeedbackProcessor *processor = NULL, const LatencyEcho &echo = LatencyEcho())
     {
         if (WDL_NOT_NORMALLY(midiMessage->size > 255)) return;
 
-        unsigned char size = (unsigned char)midiMessage->size;
-        messageQueue_.Add(&size, 1);
-        messageQueue_.Add(midiMessage->midi_message, midiMessage->size);
+        const int sysExAddressSize = processor ? processor->GetSysExAddressSize(midiMessage) : 0;
+        const SysExPriority priority = processor ? processor->GetSysExPriority(midiMessage) : SysExPriority_Control;
+        
+        if (isStagingFrame_)
+        {
+            AddFrameMessage(GetSysExTarget(processor, midiMessage, sysExAddressSize), midiMessage->midi_message, midiMessage->size, processor != NULL, sysExAddressSize, priority, echo);
+            return;
+        }
+        
+        if (processor == NULL)
+            InvalidateShadow();
+        else if ( ! UpdateSysExShadow(midiMessage->midi_message, midiMessage->size, sysExAddressSize))
+            return;
+        
+        AddQueuedMessage(priority, sysExAddressSize > 0 ? GetSysExTarget(processor, midiMessage, sysExAddressSize) : 0, midiMessage->midi_message, midiMessage->size, echo);
     }
 
-    void SendMidiMessage(int first, int second, int third)
+    void SendMidiMessage(int first, int second, int third, bool isFeedback = false, const LatencyEcho &echo = LatencyEcho())
     {
-        if (midiOutput_)
-            midiOutput_->Send(first, second, third, -1);
+        const unsigned char msg[3] = { (unsigned char)first, (unsigned char)second, (unsigned char)third };
+        
+        if (isStagingFrame_)
+        {
+            AddFrameMessage(GetShortMessageTarget(first, second), msg, sizeof(msg), isFeedback, 0, SysExPriority_Button, echo);
+            return;
+        }
+        
+        // messages that aren't feedback always go out, but still tell us what the device shows
+        if ( ! UpdateShortMessageShadow(first, second, third) && isFeedback)
+            return;
+        
+        // a bank transition is still going out for this control, this replaces what's waiting so the order holds
+        const unsigned long long target = GetShortMessageTarget(first, second);
+        
+        if (target != 0 && queuedTargets_.count(target) > 0)
+        {
+            AddQueuedMessage(SysExPriority_Button, target, msg, sizeof(msg), echo);
+            return;
+        }
+        
+        SendShortMessage(first, second, third, echo);
     }
     
     void Run()
     {
+        const int maxBytesPerRun = maxBytesPerSecond_ > 0 ? max(maxBytesPerSecond_ / max(surfaceRefreshRate_, 1), 1) : 0;
+        
         int numSent = 0;
+        int numBytesSent = 0;
         
-        while ((maxMesssagesPerRun_ == 0 || numSent < maxMesssagesPerRun_) && messageQueue_.Available() >= 1)
+        while (deque<QueuedSysExMessage> *queue = GetNextQueue())
         {
-            const unsigned char *msg = (const unsigned char *)messageQueue_.Get();
-            const int msg_len = (int) *msg;
-            if (WDL_NOT_NORMALLY(messageQueue_.Available() < 1 + msg_len)) // not enough data in queue, should not happen
+            if (maxMesssagesPerRun_ > 0 && numSent >= maxMesssagesPerRun_)
                 break;
             
-            struct
-            {
-                MIDI_event_ex_t evt;
-                char data[256];
-            } midiSysExData;
-
-            midiSysExData.evt.frame_offset = 0;
-            midiSysExData.evt.size = msg_len;
-            memcpy(midiSysExData.evt.midi_message, msg + 1, msg_len);
-            messageQueue_.Advance(1 + msg_len);
-            SendMidiSysexMessage(&midiSysExData.evt);
+            const int size = (int)queue->front().data.size();
+            
+            if (maxBytesPerRun > 0 && numSent > 0 && numBytesSent + size > maxBytesPerRun) // always at least one message a run
+                break;
+            
+            SendNextQueuedMessage();
+            
             numSent++;
+            numBytesSent += size;
+        }
+    }
+    
+    // While a frame is staged every outgoing message, short or sysex, is held back. At EndFrame a message that is
+    // followed in the same frame by another one for the same control or display (e.g. a page enter clear and the
+    // new page's value) is dropped, what's left is diffed against the hardware shadow and the changes join the
+    // priority queues. Run sends them at the usual rate, and a control changed again before its turn has the
+    // waiting message replaced, so scrolling through banks quickly doesn't pile up frames on the port.
+    void BeginFrame()
+    {
+        isStagingFrame_ = true;
+    }
+    
+    void EndFrame()
+    {
+        isStagingFrame_ = false;
+        
+        set<unsigned long long> laterTargets;
+        
+        for (int i = (int)frameMessages_.size() - 1; i >= 0; --i)
+        {
+            if (frameMessages_[i].target == 0)
+                continue;
+            
+            if ( ! laterTargets.insert(frameMessages_[i].target).second)
+                frameMessages_[i].size = 0; // superseded
+        }
+        
+        for (auto &message : frameMessages_)
+        {
+            const unsigned char *data = &frameData_[message.offset];
+            
+            if (message.size == 0)
+                continue;
+            else if (message.size == 3 && data[0] != 0xf0)
+            {
+                if ( ! UpdateShortMessageShadow(data[0], data[1], data[2]) && message.isFeedback)
+                    continue;
+                
+                AddQueuedMessage(message.priority, message.target, data, message.size, message.echo);
+            }
+            else
+            {
+                if ( ! message.isFeedback)
+                    InvalidateShadow();
+                else if ( ! UpdateSysExShadow(data, message.size, message.sysExAddressSize))
+                    continue;
+                
+                AddQueuedMessage(message.priority, message.sysExAddressSize > 0 ? message.target : 0, data, message.size, message.echo);
+            }
         }
         
-        messageQueue_.Compact();
+        frameMessages_.clear();
+        frameData_.clear();
+        
+        Run(); // the first Run's worth goes out now
     }
     
     void Flush()
     {
-        while (messageQueue_.Available() >= 1)
+        if (isStagingFrame_)
+            EndFrame();
+        
+        while (GetNextQueue() != NULL)
         {
             Sleep(2);
             
-            const unsigned char *msg = (const unsigned char *)messageQueue_.Get();
-            const int msg_len = (int) *msg;
-            if (WDL_NOT_NORMALLY(messageQueue_.Available() < 1 + msg_len)) // not enough data in queue, should not happen
+            if ( ! SendNextQueuedMessage())
                 break;
-            
-            struct
-            {
-                MIDI_event_ex_t evt;
-                char data[256];
-            } midiSysExData;
-
-            midiSysExData.evt.frame_offset = 0;
-            midiSysExData.evt.size = msg_len;
-            memcpy(midiSysExData.evt.midi_message, msg + 1, msg_len);
-            messageQueue_.Advance(1 + msg_len);
-            SendMidiSysexMessage(&midiSysExData.evt);
         }
     }
 };
@@ -2702,6 +3550,22 @@ private:
     Midi_ControlSurfaceIO *const surfaceIO_;
 
     DWORD lastRun_ = 0;
+    
+    vector<const MIDI_event_ex_t *> inputMidiMessages_; // current input batch, valid until the next SwapBufs
+    
+    /////////////////////////////////////////////////////////////////////////////
+    struct ParkedMidiMessage
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        MIDI_event_ex_t evt;
+        double arrivalTime;
+    };
+    
+    map<CSIMessageGenerator *, ParkedMidiMessage> parkedMidiMessages_; // latest parked fader move per generator, see GetShouldParkInput
+    
+    void DispatchParkedMidiMessages(CSIMessageGenerator *generator);
+    void DispatchDueMidiMessages(DWORD now);
+    virtual void ClearParkedInput() override { parkedMidiMessages_.clear(); }
 
     void ProcessMidiWidget(int &lineNumber, ifstream &surfaceTemplateFile, const vector<string> &in_tokens);
     
@@ -2732,9 +3596,14 @@ public:
 
     virtual ~Midi_ControlSurface() {}
     
-    void ProcessMidiMessage(const MIDI_event_ex_t *evt);
-    virtual void SendMidiSysExMessage(MIDI_event_ex_t *midiMessage) override;
-    virtual void SendMidiMessage(int first, int second, int third) override;
+    CSIMessageGenerator *GetMidiMessageGenerator(const MIDI_event_ex_t *evt);
+    void ProcessMidiMessage(const MIDI_event_ex_t *evt, CSIMessageGenerator *generator, double arrivalTime);
+    void AddInputMidiMessage(const MIDI_event_ex_t *evt, double arrivalTime);
+    void ProcessInputMidiMessages();
+    virtual void SendMidiSysExMessage(MIDI_event_ex_t *midiMessage) override { SendMidiSysExMessage(midiMessage, NULL); }
+    void SendMidiSysExMessage(MIDI_event_ex_t *midiMessage, Midi_FeedbackProcessor *processor);
+    virtual void SendMidiMessage(int first, int second, int third) override { SendMidiMessage(first, second, third, false); }
+    void SendMidiMessage(int first, int second, int third, bool isFeedback, const LatencyEcho &echo = LatencyEcho());
 
     virtual void SetHasMCUMeters(int displayType)
     {
@@ -2761,6 +3630,19 @@ public:
     virtual void RequestUpdate() override
     {
         const DWORD now = GetTickCount();
+        
+        if (isBankTransitionPending_) // stage the new bank as one frame, EndFrame queues what changed
+        {
+            isBankTransitionPending_ = false;
+            lastRun_ = now;
+            
+            surfaceIO_->BeginFrame();
+            RequestBankTransitionUpdate();
+            surfaceIO_->EndFrame();
+            
+            return;
+        }
+        
         const DWORD threshold = (DWORD) (1000 / max(surfaceIO_->surfaceRefreshRate_, 1));
         if ((now - lastRun_) < threshold) return;
         lastRun_=now;
@@ -2778,12 +3660,38 @@ class OSC_FeedbackProcessor : public FeedbackProcessor
 protected:
     OSC_ControlSurface *const surface_;
     string const oscAddress_;
+    int const oscAddressSymbol_; // interned here once, the trace records it with every message sent
+    string colorAddress_; // oscAddress_/Color, made on the first color sent
+    int colorAddressSymbol_ = CSISymbol_None;
+    
+    // Values are rounded to this step before dedupe, so jitter from REAPER's volume/pan math and automation
+    // doesn't turn into a stream of identical looking packets. The default is finer than any OSC fader can show,
+    // a widget file can set a coarser one after the address -- FB_Processor /track/1/volume 1/1024
+    static constexpr double DefaultResolution = 1.0 / 16384.0;
+    double resolution_ = DefaultResolution;
+    
+    double Quantize(double value) { return resolution_ > 0.0 ? floor(value / resolution_ + 0.5) * resolution_ : value; }
     
 public:
-    OSC_FeedbackProcessor(CSurfIntegrator *const csi, OSC_ControlSurface *surface, Widget *widget, const string &oscAddress) : FeedbackProcessor(csi, widget), surface_(surface), oscAddress_(oscAddress) {}
+    OSC_FeedbackProcessor(CSurfIntegrator *const csi, OSC_ControlSurface *surface, Widget *widget, const string &oscAddress) : FeedbackProcessor(csi, widget), surface_(surface), oscAddress_(oscAddress), oscAddressSymbol_(InternSymbol(oscAddress.c_str())) {}
     ~OSC_FeedbackProcessor() {}
 
     virtual const char *GetName() override { return "OSC_FeedbackProcessor"; }
+    
+    void SetResolution(const char *resolution); // "0.1", "1/1024", "0" turns quantizing off
+    
+    virtual void SetValue(const PropertyList &properties, double value) override
+    {
+        value = Quantize(value);
+        
+        if (lastDoubleValue_ != value)
+        {
+            lastDoubleValue_ = value;
+            ForceValue(properties, value);
+        }
+    }
+    
+    using FeedbackProcessor::SetValue;
 
     virtual void SetColorValue(const rgba_color &color) override;
     virtual void ForceValue(const PropertyList &properties, double value) override;
@@ -2812,6 +3720,7 @@ class OSC_ControlSurfaceIO
 protected:
     CSurfIntegrator *const csi_;
     string const name_;
+    int const symbol_; // same name, and so the same symbol, as the surfaces on this device
     int const channelCount_;
     oscpkt::UdpSocket *inSocket_ = NULL;
     oscpkt::UdpSocket *outSocket_ = NULL;
@@ -2822,6 +3731,102 @@ protected:
     int maxPacketsPerRun_; // 0 = no limit
     int sentPacketCount_= 0; // count of packets sent this Run() slice, after maxPacketsPerRun_ packtees go into packetQueue_
     WDL_Queue packetQueue_;
+    vector<LatencyEcho> packetEchoes_; // latency tracing, for the messages in the packet being built
+    deque<vector<LatencyEcho>> queuedPacketEchoes_; // one per packet in packetQueue_
+    
+    bool GetIsPacketLimitReached() { return maxPacketsPerRun_ != 0 && sentPacketCount_ >= maxPacketsPerRun_; }
+    
+    // Hardware shadow -- the last feedback value sent to each address, shared by every page's surface on this device
+    /////////////////////////////////////////////////////////////////////////////
+    struct ShadowValue
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        char type = 0; // 'f', 'i' or 's'
+        float floatValue = 0.0f;
+        int intValue = 0;
+        string stringValue;
+        int addressSymbol = CSISymbol_None; // for the trace, not part of the value
+        LatencyEcho echo; // not part of the value either
+        
+        bool operator == (const ShadowValue &other) const
+        {
+            if (type != other.type)
+                return false;
+            else if (type == 'f')
+                return floatValue == other.floatValue;
+            else if (type == 'i')
+                return intValue == other.intValue;
+            else
+                return stringValue == other.stringValue;
+        }
+    };
+    
+    map<const string, ShadowValue> shadow_;
+    
+    // A bank transition's feedback waits here by address, in the order it was first set, and is diffed against
+    // the shadow when its turn comes. It goes out at maxPacketsPerRun_ a Run like everything else, and a newer
+    // value for an address still waiting replaces the old one, so scrolling through banks quickly doesn't pile up packets.
+    bool isStagingFrame_ = false;
+    deque<string> pendingAddresses_;
+    map<const string, ShadowValue> pendingValues_;
+    
+    // returns true if the value was left to wait
+    bool AddPendingValue(const char *oscAddress, const ShadowValue &value)
+    {
+        if (pendingValues_.empty() && ! isStagingFrame_)
+            return false;
+        
+        auto it = pendingValues_.find(oscAddress);
+        
+        if (it != pendingValues_.end())
+            it->second = value;
+        else if (isStagingFrame_)
+        {
+            pendingValues_[oscAddress] = value;
+            pendingAddresses_.push_back(oscAddress);
+        }
+        else
+            return false;
+        
+        return true;
+    }
+    
+    void SendShadowedValue(const char *oscAddress, const ShadowValue &value)
+    {
+        ShadowValue &shown = shadow_[oscAddress];
+        if (shown == value)
+            return;
+        
+        shown = value;
+        
+        if (value.type == 'f')
+            SendOSCMessage(oscAddress, value.addressSymbol, (double)value.floatValue, value.echo);
+        else if (value.type == 'i')
+            SendOSCMessage(oscAddress, value.addressSymbol, value.intValue, value.echo);
+        else
+            SendOSCMessage(oscAddress, value.addressSymbol, value.stringValue.c_str(), value.echo);
+    }
+    
+    void SendPendingValues()
+    {
+        while ( ! pendingAddresses_.empty() && ! GetIsPacketLimitReached())
+        {
+            string oscAddress = pendingAddresses_.front();
+            pendingAddresses_.pop_front();
+            
+            auto it = pendingValues_.find(oscAddress);
+            ShadowValue value = it->second;
+            pendingValues_.erase(it);
+            
+            SendShadowedValue(oscAddress.c_str(), value);
+        }
+    }
+    
+    void SendOSCFeedbackValue(const char *oscAddress, const ShadowValue &value)
+    {
+        if ( ! AddPendingValue(oscAddress, value))
+            SendShadowedValue(oscAddress, value);
+    }
     
 public:
     OSC_ControlSurfaceIO(CSurfIntegrator *const csi, const char *name, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun);
@@ -2831,208 +3836,714 @@ public:
 
     const int GetChannelCount() { return channelCount_; }
     
-    virtual void HandleExternalInput(OSC_ControlSurface *surface);
-
-    void QueuePacket(const void *p, int sz)
+    virtual void HandleExternalInput(OSC_ControlSurface *surface);
+
+    void QueuePacket(const void *p, int sz)
+    {
+        if (WDL_NOT_NORMALLY(!outSocket_)) return;
+        if (WDL_NOT_NORMALLY(!p || sz < 1)) return;
+        if (WDL_NOT_NORMALLY(packetQueue_.GetSize() > 32*1024*1024)) { packetEchoes_.clear(); return; } // drop packets after 32MB queued
+        if (GetIsPacketLimitReached())
+        {
+            void *wr = packetQueue_.Add(NULL,sz + sizeof(int));
+            if (WDL_NORMALLY(wr != NULL))
+            {
+                memcpy(wr, &sz, sizeof(int));
+                memcpy((char *)wr + sizeof(int), p, sz);
+                queuedPacketEchoes_.push_back(vector<LatencyEcho>());
+                queuedPacketEchoes_.back().swap(packetEchoes_);
+            }
+        }
+        else
+        {
+            outSocket_->sendPacket(p, sz);
+            sentPacketCount_++;
+            
+            for (auto &echo : packetEchoes_)
+                echo.Record();
+        }
+        
+        packetEchoes_.clear();
+    }
+
+    void QueueOSCMessage(oscpkt::Message *message, const LatencyEcho &echo = LatencyEcho()) // NULL message flushes any latent bundles
+    {
+        if (outSocket_ != NULL && outSocket_->isOk())
+        {
+            if (maxBundleSize_ > 0 && packetWriter_.packetSize() > 0)
+            {
+                bool send_bundle;
+                if (message)
+                {
+                    // oscpkt lacks the ability to calculate the size of a Message?
+                    storageTmp_.clear();
+                    message->packMessage(storageTmp_, true);
+                    send_bundle = (packetWriter_.packetSize() + storageTmp_.size() > maxBundleSize_);
+                }
+                else
+                {
+                    send_bundle = true;
+                }
+
+                if (send_bundle)
+                {
+                    packetWriter_.endBundle();
+                    QueuePacket(packetWriter_.packetData(), packetWriter_.packetSize());
+                    packetWriter_.init();
+                }
+            }
+
+            if (message)
+            {
+                if (maxBundleSize_ > 0 && packetWriter_.packetSize() == 0)
+                {
+                    packetWriter_.startBundle();
+                }
+
+                packetWriter_.addMessage(*message);
+                
+                if (echo.trace != NULL)
+                    packetEchoes_.push_back(echo);
+
+                if (maxBundleSize_ <= 0)
+                {
+                    QueuePacket(packetWriter_.packetData(), packetWriter_.packetSize());
+                    packetWriter_.init();
+                }
+            }
+        }
+    }
+    
+    void InvalidateShadow() { shadow_.clear(); }
+    void InvalidateShadow(const string &oscAddress) { shadow_.erase(oscAddress); } // input on an address, the device may show anything now
+    
+    // the input addresses the surfaces on this device listen to, only devices that can filter use them
+    virtual void AddSubscription(const string &oscAddress) {}
+    virtual void ClearSubscriptions() {}
+    
+    // addressSymbol is the address interned by whoever owns it (a feedback processor, zone or action), the trace
+    // records the message here, once the shadow has decided it goes out
+    void SendOSCFeedbackMessage(const char *oscAddress, int addressSymbol, double value, const LatencyEcho &echo)
+    {
+        ShadowValue shadowValue;
+        shadowValue.type = 'f';
+        shadowValue.floatValue = (float)value;
+        shadowValue.addressSymbol = addressSymbol;
+        shadowValue.echo = echo;
+        SendOSCFeedbackValue(oscAddress, shadowValue);
+    }
+    
+    void SendOSCFeedbackMessage(const char *oscAddress, int addressSymbol, int value, const LatencyEcho &echo)
+    {
+        ShadowValue shadowValue;
+        shadowValue.type = 'i';
+        shadowValue.intValue = value;
+        shadowValue.addressSymbol = addressSymbol;
+        shadowValue.echo = echo;
+        SendOSCFeedbackValue(oscAddress, shadowValue);
+    }
+    
+    void SendOSCFeedbackMessage(const char *oscAddress, int addressSymbol, const char *value, const LatencyEcho &echo)
+    {
+        ShadowValue shadowValue;
+        shadowValue.type = 's';
+        shadowValue.stringValue = value;
+        shadowValue.addressSymbol = addressSymbol;
+        shadowValue.echo = echo;
+        SendOSCFeedbackValue(oscAddress, shadowValue);
+    }
+    
+    void SendOSCMessage(const char *oscAddress, int addressSymbol, double value, const LatencyEcho &echo = LatencyEcho())
+    {
+        if (outSocket_ != NULL && outSocket_->isOk())
+        {
+            g_traceRing.Record(TraceEvent_OSCOut, symbol_, addressSymbol, value);
+            
+            oscpkt::Message message;
+            message.init(oscAddress).pushFloat((float)value);
+            QueueOSCMessage(&message, echo);
+        }
+    }
+    
+    void SendOSCMessage(const char *oscAddress, int addressSymbol, int value, const LatencyEcho &echo = LatencyEcho())
+    {
+        if (outSocket_ != NULL && outSocket_->isOk())
+        {
+            g_traceRing.Record(TraceEvent_OSCOut, symbol_, addressSymbol, value);
+            
+            oscpkt::Message message;
+            message.init(oscAddress).pushInt32(value);
+            QueueOSCMessage(&message, echo);
+        }
+    }
+    
+    void SendOSCMessage(const char *oscAddress, int addressSymbol, const char *value, const LatencyEcho &echo = LatencyEcho())
+    {
+        if (outSocket_ != NULL && outSocket_->isOk())
+        {
+            g_traceRing.Record(TraceEvent_OSCOut, symbol_, addressSymbol, 0.0);
+            
+            oscpkt::Message message;
+            message.init(oscAddress).pushStr(value);
+            QueueOSCMessage(&message, echo);
+        }
+    }
+    
+    void SendOSCMessage(const char *oscAddress, int addressSymbol)
+    {
+        if (outSocket_ != NULL && outSocket_->isOk())
+        {
+            g_traceRing.Record(TraceEvent_OSCOut, symbol_, addressSymbol, 0.0);
+            
+            oscpkt::Message message;
+            message.init(oscAddress);
+            QueueOSCMessage(&message);
+        }
+    }
+    
+    void BeginRun()
+    {
+        sentPacketCount_ = 0;
+        // send any latent packets first
+        while (packetQueue_.GetSize()>=sizeof(int))
+        {
+            int sza;
+            if (GetIsPacketLimitReached()) break;
+
+            memcpy(&sza, packetQueue_.Get(), sizeof(int));
+            packetQueue_.Advance(sizeof(int));
+            if (WDL_NOT_NORMALLY(sza < 0 || packetQueue_.GetSize() < sza))
+            {
+                packetQueue_.Clear();
+                queuedPacketEchoes_.clear();
+            }
+            else
+            {
+                if (WDL_NORMALLY(outSocket_ != NULL))
+                {
+                    outSocket_->sendPacket(packetQueue_.Get(), sza);
+                }
+                packetQueue_.Advance(sza);
+                sentPacketCount_++;
+                
+                if ( ! queuedPacketEchoes_.empty())
+                {
+                    for (auto &echo : queuedPacketEchoes_.front())
+                        echo.Record();
+                    
+                    queuedPacketEchoes_.pop_front();
+                }
+            }
+        }
+        packetQueue_.Compact();
+        
+        SendPendingValues();
+    }
+
+    virtual void Run()
+    {
+        QueueOSCMessage(NULL); // flush any latent bundles
+    }
+    
+    void BeginFrame()
+    {
+        isStagingFrame_ = true;
+        BeginRun();
+    }
+    
+    void EndFrame()
+    {
+        isStagingFrame_ = false;
+        SendPendingValues();
+        Run();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSC_X32ControlSurfaceIO :public OSC_ControlSurfaceIO
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+protected:
+    // The console pushes every parameter change to a client for 10 seconds after /xremote, so it is renewed well within that.
+    // It has no change driven subscription for single parameters (/subscribe resends the value at a fixed rate),
+    // so instead the changes are filtered here against what the surfaces listen to, before they reach the surfaces.
+    DWORD X32HeartBeatRefreshInterval_ = 5000;
+    DWORD X32HeartBeatLastRefreshTime_ = GetTickCount() - 30000;
+    
+    set<string> subscriptions_;
+    
+    // From firmware 4 /xremotenfb does the same as /xremote without echoing CSI's own feedback back as input.
+    // The firmware version comes from the /xinfo reply, until then /xremote is used. The console may not be up
+    // yet when CSI starts, so /xinfo goes out with every heartbeat until it answers.
+    int firmwareMajorVersion_ = 0;
+    bool hasInfo_ = false;
+    
+    const char *GetHeartBeatMessage() { return firmwareMajorVersion_ >= 4 ? "/xremotenfb" : "/xremote"; }
+    
+    void HandleInfo(oscpkt::Message *message)
+    {
+        string ip, name, model, version;
+        
+        if (message->arg().popStr(ip).popStr(name).popStr(model).popStr(version).isOk())
+        {
+            firmwareMajorVersion_ = atoi(version.c_str());
+            hasInfo_ = true;
+            X32HeartBeatLastRefreshTime_ = GetTickCount() - 30000; // switch right away
+            
+            if (g_surfaceInDisplay) LogToConsole(MEDBUF, "IN <- %s %s %s firmware %s, using %s\n", name_.c_str(), name.c_str(), model.c_str(), version.c_str(), GetHeartBeatMessage());
+        }
+    }
+    
+public:
+    OSC_X32ControlSurfaceIO(CSurfIntegrator *const csi, const char *name, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun);
+    virtual ~OSC_X32ControlSurfaceIO() {}
+
+    virtual void HandleExternalInput(OSC_ControlSurface *surface) override;
+    
+    virtual void AddSubscription(const string &oscAddress) override { subscriptions_.insert(oscAddress); }
+    virtual void ClearSubscriptions() override { subscriptions_.clear(); }
+
+    void Run() override
+    {
+        DWORD currentTime = GetTickCount();
+
+        if ((currentTime - X32HeartBeatLastRefreshTime_) > X32HeartBeatRefreshInterval_)
+        {
+            X32HeartBeatLastRefreshTime_ = currentTime;
+            
+            if ( ! hasInfo_)
+                SendOSCMessage("/xinfo", CSISymbol_None);
+            
+            SendOSCMessage(GetHeartBeatMessage(), CSISymbol_None);
+        }
+        
+        OSC_ControlSurfaceIO::Run();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class OSC_ControlSurface : public ControlSurface
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    OSC_ControlSurfaceIO *const surfaceIO_;
+    vector<pair<string, double>> inputOSCMessages_; // current input batch
+    
+    /////////////////////////////////////////////////////////////////////////////
+    struct ParkedOSCMessage
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        string oscAddress;
+        double value;
+        double arrivalTime;
+    };
+    
+    map<CSIMessageGenerator *, ParkedOSCMessage> parkedOSCMessages_; // latest parked fader move per generator, see GetShouldParkInput
+    
+    void DispatchParkedOSCMessages(CSIMessageGenerator *generator);
+    void DispatchDueOSCMessages(DWORD now);
+    virtual void ClearParkedInput() override { parkedOSCMessages_.clear(); }
+    
+    void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, const vector<string> &in_tokens);
+    void ProcessOSCWidgetFile(const string &filePath);
+public:
+    OSC_ControlSurface(CSurfIntegrator *const csi, Page *page, const char *name, int channelOffset, const char *templateFilename, const char *zoneFolder, const char *fxZoneFolder, OSC_ControlSurfaceIO *surfaceIO);
+
+    virtual ~OSC_ControlSurface() {}
+    
+    void ProcessOSCMessage(const char *message, double value, CSIMessageGenerator *generator, double arrivalTime);
+    void AddInputOSCMessage(const char *message, double value, double arrivalTime);
+    void AddOSCMessageGenerator(const string &oscAddress, unique_ptr<CSIMessageGenerator> generator);
+    void ProcessInputOSCMessages();
+    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, double value);
+    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, int value);
+    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int addressSymbol, const char *value);
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol) override;
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, int value) override;
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, double value) override;
+    virtual void SendOSCMessage(const char *zoneName, int addressSymbol, const char *value) override;
+
+    virtual void RequestUpdate() override
+    {
+        if (isBankTransitionPending_)
+        {
+            isBankTransitionPending_ = false;
+            
+            surfaceIO_->BeginFrame();
+            RequestBankTransitionUpdate();
+            surfaceIO_->EndFrame();
+            
+            return;
+        }
+        
+        surfaceIO_->BeginRun();
+        ControlSurface::RequestUpdate();
+        surfaceIO_->Run();
+    }
+
+    virtual void HandleExternalInput() override
+    {
+        surfaceIO_->HandleExternalInput(this);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TrackSelection
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // The selected tracks in REAPER's order, as a set and a count. It's read again only after SetSurfaceSelected,
+    // OnTrackSelection or a track list change, or when the once per tick check finds REAPER disagrees with it.
+    // That check can't see a change in the middle of the list, so it's also read again every RereadTicks ticks.
+private:
+    static const int RereadTicks = 30; // about a second at the 33 ms tick
+    
+    vector<MediaTrack *> tracks_; // master not included, like GetSelectedTrack
+    unordered_set<MediaTrack *> trackSet_;
+    bool isMasterSelected_ = false;
+    bool isDirty_ = true;
+    int ticksSinceRebuild_ = 0;
+    
+    void Rebuild()
+    {
+        tracks_.clear();
+        trackSet_.clear();
+        
+        for (int i = 0; i < CountSelectedTracks2(NULL, false); ++i)
+        {
+            MediaTrack *track = DAW::GetSelectedTrack(i);
+            tracks_.push_back(track);
+            trackSet_.insert(track);
+        }
+        
+        isMasterSelected_ = GetMediaTrackInfo_Value(GetMasterTrack(NULL), "I_SELECTED") != 0;
+        isDirty_ = false;
+        ticksSinceRebuild_ = 0;
+    }
+    
+public:
+    void SetDirty() { isDirty_ = true; }
+    
+    // catches a change that came without a notification, the count and the ends of the list are all it looks at,
+    // called once per tick
+    void Validate()
+    {
+        if (isDirty_)
+            return;
+        
+        if (++ticksSinceRebuild_ >= RereadTicks)
+        {
+            isDirty_ = true;
+            return;
+        }
+        
+        int count = CountSelectedTracks2(NULL, false);
+        
+        if (count != (int)tracks_.size())
+            isDirty_ = true;
+        else if (count > 0 && (DAW::GetSelectedTrack(0) != tracks_.front() || DAW::GetSelectedTrack(count - 1) != tracks_.back()))
+            isDirty_ = true;
+        else if ((CountSelectedTracks2(NULL, true) > count) != isMasterSelected_)
+            isDirty_ = true;
+    }
+    
+    const vector<MediaTrack *> &GetTracks()
+    {
+        if (isDirty_)
+            Rebuild();
+        
+        return tracks_;
+    }
+    
+    int GetCount() { return (int)GetTracks().size(); }
+    
+    bool GetIsSelected(MediaTrack *track)
+    {
+        if (isDirty_)
+            Rebuild();
+        
+        return trackSet_.count(track) > 0 || (isMasterSelected_ && track == GetMasterTrack(NULL));
+    }
+    
+    // the selected track when exactly one is
+    MediaTrack *GetOnlyTrack()
+    {
+        const vector<MediaTrack *> &tracks = GetTracks();
+        
+        return tracks.size() == 1 ? tracks[0] : NULL;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TrackStateSnapshot
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // The track state feedback shows, read from REAPER at most once per track per tick. Page::Run opens it once input
+    // has been handled and closes it when every surface has been updated, so all the widgets on all the surfaces that
+    // show a track see the same values, from one set of API calls. Nothing taken is read again until the next tick.
+    // While it's closed, for input, Touch and anything outside Run, the reads go straight to REAPER.
+private:
+    enum
+    {
+        Has_VolPan = 1,
+        Has_Mute = 2,
+        Has_Solo = 4,
+        Has_RecArm = 8,
+        Has_Peaks = 16,
+        Has_Color = 32,
+    };
+    
+    struct TrackState
+    {
+        int flags = 0;
+        double volume = 0.0;
+        double pan = 0.0;
+        bool isMuted = false;
+        double solo = 0.0;
+        double recArm = 0.0;
+        double peaks[2] = { 0.0, 0.0 };
+        rgba_color color;
+    };
+    
+    unordered_map<MediaTrack *, TrackState> states_;
+    bool isOpen_ = false;
+    int isAnyTrackSoloed_ = -1;
+    
+public:
+    void Open()
+    {
+        states_.clear();
+        isAnyTrackSoloed_ = -1;
+        isOpen_ = true;
+    }
+    
+    void Close() { isOpen_ = false; }
+    
+    void GetVolPan(MediaTrack *track, double *volume, double *pan)
     {
-        if (WDL_NOT_NORMALLY(!outSocket_)) return;
-        if (WDL_NOT_NORMALLY(!p || sz < 1)) return;
-        if (WDL_NOT_NORMALLY(packetQueue_.GetSize() > 32*1024*1024)) return; // drop packets after 32MB queued
-        if (maxPacketsPerRun_ != 0 && sentPacketCount_ >= maxPacketsPerRun_)
+        if ( ! isOpen_)
         {
-            void *wr = packetQueue_.Add(NULL,sz + sizeof(int));
-            if (WDL_NORMALLY(wr != NULL))
-            {
-                memcpy(wr, &sz, sizeof(int));
-                memcpy((char *)wr + sizeof(int), p, sz);
-            }
+            GetTrackUIVolPan(track, volume, pan);
+            return;
         }
-        else
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_VolPan))
         {
-            outSocket_->sendPacket(p, sz);
-            sentPacketCount_++;
+            GetTrackUIVolPan(track, &state.volume, &state.pan);
+            state.flags |= Has_VolPan;
         }
+        
+        *volume = state.volume;
+        *pan = state.pan;
     }
-
-    void QueueOSCMessage(oscpkt::Message *message) // NULL message flushes any latent bundles
+    
+    bool GetIsMuted(MediaTrack *track)
     {
-        if (outSocket_ != NULL && outSocket_->isOk())
+        bool mute = false;
+        
+        if ( ! isOpen_)
         {
-            if (maxBundleSize_ > 0 && packetWriter_.packetSize() > 0)
-            {
-                bool send_bundle;
-                if (message)
-                {
-                    // oscpkt lacks the ability to calculate the size of a Message?
-                    storageTmp_.clear();
-                    message->packMessage(storageTmp_, true);
-                    send_bundle = (packetWriter_.packetSize() + storageTmp_.size() > maxBundleSize_);
-                }
-                else
-                {
-                    send_bundle = true;
-                }
-
-                if (send_bundle)
-                {
-                    packetWriter_.endBundle();
-                    QueuePacket(packetWriter_.packetData(), packetWriter_.packetSize());
-                    packetWriter_.init();
-                }
-            }
-
-            if (message)
-            {
-                if (maxBundleSize_ > 0 && packetWriter_.packetSize() == 0)
-                {
-                    packetWriter_.startBundle();
-                }
-
-                packetWriter_.addMessage(*message);
-
-                if (maxBundleSize_ <= 0)
-                {
-                    QueuePacket(packetWriter_.packetData(), packetWriter_.packetSize());
-                    packetWriter_.init();
-                }
-            }
+            GetTrackUIMute(track, &mute);
+            return mute;
         }
-    }
-    
-    void SendOSCMessage(const char *oscAddress, double value)
-    {
-        if (outSocket_ != NULL && outSocket_->isOk())
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_Mute))
         {
-            oscpkt::Message message;
-            message.init(oscAddress).pushFloat((float)value);
-            QueueOSCMessage(&message);
+            GetTrackUIMute(track, &mute);
+            state.isMuted = mute;
+            state.flags |= Has_Mute;
         }
+        
+        return state.isMuted;
     }
     
-    void SendOSCMessage(const char *oscAddress, int value)
+    double GetSolo(MediaTrack *track)
     {
-        if (outSocket_ != NULL && outSocket_->isOk())
+        if ( ! isOpen_)
+            return GetMediaTrackInfo_Value(track, "I_SOLO");
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_Solo))
         {
-            oscpkt::Message message;
-            message.init(oscAddress).pushInt32(value);
-            QueueOSCMessage(&message);
+            state.solo = GetMediaTrackInfo_Value(track, "I_SOLO");
+            state.flags |= Has_Solo;
         }
+        
+        return state.solo;
     }
     
-    void SendOSCMessage(const char *oscAddress, const char *value)
+    double GetRecArm(MediaTrack *track)
     {
-        if (outSocket_ != NULL && outSocket_->isOk())
+        if ( ! isOpen_)
+            return GetMediaTrackInfo_Value(track, "I_RECARM");
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_RecArm))
         {
-            oscpkt::Message message;
-            message.init(oscAddress).pushStr(value);
-            QueueOSCMessage(&message);
+            state.recArm = GetMediaTrackInfo_Value(track, "I_RECARM");
+            state.flags |= Has_RecArm;
         }
+        
+        return state.recArm;
     }
     
-    void SendOSCMessage(const char *value)
+    // left and right are kept, other channels are read every time
+    double GetPeak(MediaTrack *track, int channel)
     {
-        if (outSocket_ != NULL && outSocket_->isOk())
+        if ( ! isOpen_ || channel < 0 || channel > 1)
+            return Track_GetPeakInfo(track, channel);
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_Peaks))
         {
-            oscpkt::Message message;
-            message.init(value);
-            QueueOSCMessage(&message);
+            state.peaks[0] = Track_GetPeakInfo(track, 0);
+            state.peaks[1] = Track_GetPeakInfo(track, 1);
+            state.flags |= Has_Peaks;
         }
+        
+        return state.peaks[channel];
     }
     
-    void BeginRun()
+    rgba_color GetColor(MediaTrack *track)
     {
-        sentPacketCount_ = 0;
-        // send any latent packets first
-        while (packetQueue_.GetSize()>=sizeof(int))
+        if ( ! isOpen_)
+            return DAW::GetTrackColor(track);
+        
+        TrackState &state = states_[track];
+        
+        if ( ! (state.flags & Has_Color))
         {
-            int sza;
-            if (maxPacketsPerRun_ != 0 && sentPacketCount_ >= maxPacketsPerRun_) break;
-
-            memcpy(&sza, packetQueue_.Get(), sizeof(int));
-            packetQueue_.Advance(sizeof(int));
-            if (WDL_NOT_NORMALLY(sza < 0 || packetQueue_.GetSize() < sza))
-            {
-                packetQueue_.Clear();
-            }
-            else
-            {
-                if (WDL_NORMALLY(outSocket_ != NULL))
-                {
-                    outSocket_->sendPacket(packetQueue_.Get(), sza);
-                }
-                packetQueue_.Advance(sza);
-                sentPacketCount_++;
-            }
+            state.color = DAW::GetTrackColor(track);
+            state.flags |= Has_Color;
         }
-        packetQueue_.Compact();
+        
+        return state.color;
     }
-
-    virtual void Run()
+    
+    bool GetIsAnyTrackSoloed()
     {
-        QueueOSCMessage(NULL); // flush any latent bundles
+        if ( ! isOpen_)
+            return AnyTrackSolo(NULL);
+        
+        if (isAnyTrackSoloed_ < 0)
+            isAnyTrackSoloed_ = AnyTrackSolo(NULL) ? 1 : 0;
+        
+        return isAnyTrackSoloed_ != 0;
     }
+    
+    // another track is soloed and this one isn't, the meters go blank
+    bool GetIsSoloedOut(MediaTrack *track) { return GetIsAnyTrackSoloed() && ! GetSolo(track); }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class OSC_X32ControlSurfaceIO :public OSC_ControlSurfaceIO
+class TrackStateSnapshotScope
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-protected:
-    DWORD X32HeartBeatRefreshInterval_ = 5000;
-    DWORD X32HeartBeatLastRefreshTime_ = GetTickCount() - 30000;
+    // Keeps the snapshot open for the scope, it's closed again even when an update throws
+private:
+    TrackStateSnapshot &trackStateSnapshot_;
     
 public:
-    OSC_X32ControlSurfaceIO(CSurfIntegrator *const csi, const char *name, int channelCount, const char *receiveOnPort, const char *transmitToPort, const char *transmitToIpAddress, int maxPacketsPerRun);
-    virtual ~OSC_X32ControlSurfaceIO() {}
-
-    virtual void HandleExternalInput(OSC_ControlSurface *surface) override;
-
-    void Run() override
-    {
-        DWORD currentTime = GetTickCount();
-
-        if ((currentTime - X32HeartBeatLastRefreshTime_) > X32HeartBeatRefreshInterval_)
-        {
-            X32HeartBeatLastRefreshTime_ = currentTime;
-            SendOSCMessage("/xremote");
-        }
-        
-        OSC_ControlSurfaceIO::Run();
-    }
+    TrackStateSnapshotScope(TrackStateSnapshot &trackStateSnapshot) : trackStateSnapshot_(trackStateSnapshot) { trackStateSnapshot_.Open(); }
+    ~TrackStateSnapshotScope() { trackStateSnapshot_.Close(); }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class OSC_ControlSurface : public ControlSurface
+class TrackTopology
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+    // Folder parent/child and VCA leader/follower relations for the Folder and VCA modes. Reading them takes several
+    // API calls per track, so they are only all read again when the track list has changed. A folder or group edit
+    // leaves the track list alone, it's caught by comparing a few tracks against REAPER at most every CheckInterval,
+    // round robin. In between the modes get their tracks from here in O(children).
+public:
+    static const int NumVCAGroups = 64;
+    
 private:
-    OSC_ControlSurfaceIO *const surfaceIO_;
-    void ProcessOSCWidget(int &lineNumber, ifstream &surfaceTemplateFile, const vector<string> &in_tokens);
-    void ProcessOSCWidgetFile(const string &filePath);
+    static const int CheckInterval = 30; // ms
+    static const int TracksPerCheck = 16;
+    
+    struct TrackRelations
+    {
+        MediaTrack *track = NULL;
+        int folderDepth = 0;
+        uint64_t leadGroups = 0;
+        uint64_t followGroups = 0;
+        
+        bool operator==(const TrackRelations &other) const
+        {
+            return track == other.track && folderDepth == other.folderDepth && leadGroups == other.leadGroups && followGroups == other.followGroups;
+        }
+    };
+    
+    int structureGeneration_ = -1;
+    DWORD lastCheckTime_ = 0;
+    int nextCheckedTrack_ = 0;
+    
+    vector<TrackRelations> trackRelations_; // CSurf_TrackFromID order, as last read
+    unordered_map<MediaTrack *, int> trackIndices_; // CSurf_TrackFromID order
+    
+    vector<MediaTrack *> folderTopParentTracks_;
+    unordered_map<MediaTrack *, vector<MediaTrack *>> folderTracks_; // parent -> the parent followed by its direct children
+    
+    vector<MediaTrack *> vcaTopLeadTracks_;
+    unordered_map<MediaTrack *, uint64_t> vcaLeadGroups_; // leader -> bit n set for each group n + 1 it leads
+    vector<MediaTrack *> vcaFollowerTracks_[NumVCAGroups]; // in track order
+    
+    static void ReadRelations(MediaTrack *track, TrackRelations &relations);
+    void Rebuild(bool followMCP);
+    bool GetHasTrackChanged();
+    
 public:
-    OSC_ControlSurface(CSurfIntegrator *const csi, Page *page, const char *name, int channelOffset, const char *templateFilename, const char *zoneFolder, const char *fxZoneFolder, OSC_ControlSurfaceIO *surfaceIO);
-
-    virtual ~OSC_ControlSurface() {}
+    void Update(int structureGeneration, bool followMCP)
+    {
+        if (structureGeneration != structureGeneration_ || GetHasTrackChanged())
+        {
+            structureGeneration_ = structureGeneration;
+            Rebuild(followMCP);
+        }
+    }
     
-    void ProcessOSCMessage(const char *message, double value);
-    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, double value);
-    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, int value);
-    void SendOSCMessage(OSC_FeedbackProcessor *feedbackProcessor, const char *oscAddress, const char *value);
-    virtual void SendOSCMessage(const char *zoneName) override;
-    virtual void SendOSCMessage(const char *zoneName, int value) override;
-    virtual void SendOSCMessage(const char *zoneName, double value) override;
-    virtual void SendOSCMessage(const char *zoneName, const char *value) override;
-
-    virtual void RequestUpdate() override
+    bool GetHasTrack(MediaTrack *track) { return trackIndices_.count(track) > 0; }
+    
+    const vector<MediaTrack *> &GetFolderTopParentTracks() { return folderTopParentTracks_; }
+    bool GetIsFolderParent(MediaTrack *track) { return folderTracks_.count(track) > 0; }
+    
+    void GetFolderSpillTracks(MediaTrack *parent, vector<MediaTrack *> &tracks)
     {
-        surfaceIO_->BeginRun();
-        ControlSurface::RequestUpdate();
-        surfaceIO_->Run();
+        auto it = folderTracks_.find(parent);
+        
+        if (it != folderTracks_.end())
+            tracks.insert(tracks.end(), it->second.begin(), it->second.end());
     }
-
-    virtual void HandleExternalInput() override
+    
+    const vector<MediaTrack *> &GetVCATopLeadTracks() { return vcaTopLeadTracks_; }
+    bool GetIsVCALeader(MediaTrack *track) { return vcaLeadGroups_.count(track) > 0; }
+    
+    // the leader followed by the followers of every group it leads, in track order
+    void GetVCASpillTracks(MediaTrack *leader, vector<MediaTrack *> &tracks)
     {
-        surfaceIO_->HandleExternalInput(this);
+        tracks.push_back(leader);
+        
+        auto it = vcaLeadGroups_.find(leader);
+        
+        if (it == vcaLeadGroups_.end())
+            return;
+        
+        size_t firstFollower = tracks.size();
+        
+        for (int group = 0; group < NumVCAGroups; ++group)
+            if (it->second & ((uint64_t)1 << group))
+                tracks.insert(tracks.end(), vcaFollowerTracks_[group].begin(), vcaFollowerTracks_[group].end());
+        
+        sort(tracks.begin() + firstFollower, tracks.end(), [this](MediaTrack *a, MediaTrack *b) { return trackIndices_[a] < trackIndices_[b]; });
+        tracks.erase(unique(tracks.begin() + firstFollower, tracks.end()), tracks.end()); // a track can follow more than one of the groups
     }
 };
 
@@ -3057,8 +4568,17 @@ protected:
     vector<int> colors_;
 
     vector<MediaTrack *> tracks_;
+    unordered_map<MediaTrack *, int> trackIndices_; // position in tracks_, rebuilt with it
     vector<MediaTrack *> selectedTracks_;
     
+    // The lists are rebuilt from REAPER every Run, so their pointers are good until the track list changes again.
+    // Each keeps the structure generation it was built in, a list from an older one is checked with ValidatePtr.
+    int tracksGeneration_ = -1;
+    int selectedTracksGeneration_ = -1;
+    int vcaTracksGeneration_ = -1;
+    int folderTracksGeneration_ = -1;
+    int rebuildCount_ = 0;
+    
     vector<MediaTrack *> vcaTopLeadTracks_;
     MediaTrack           *vcaLeadTrack_ = NULL;
     vector<MediaTrack *> vcaLeadTracks_;
@@ -3068,7 +4588,8 @@ protected:
     MediaTrack           *folderParentTrack_ = NULL;
     vector<MediaTrack *> folderParentTracks_;
     vector<MediaTrack *> folderSpillTracks_;
-    map<MediaTrack*, vector<MediaTrack*>> folderDictionary_;
+    
+    TrackTopology trackTopology_;
  
     vector<unique_ptr<Navigator>> fixedTrackNavigators_;
     vector<unique_ptr<Navigator>> trackNavigators_;
@@ -3076,6 +4597,77 @@ protected:
     unique_ptr<Navigator> selectedTrackNavigator_;
     unique_ptr<Navigator> focusedFXNavigator_;
     
+    unordered_map<MediaTrack *, Navigator *> fixedTrackNavigatorsByTrack_;
+    unordered_map<int, Navigator *> trackNavigatorsByChannel_;
+    
+    // what the channel -> track mapping depends on, trackNavigatorsByTrack_ is rebuilt when any of it changes
+    struct ChannelMapping
+    {
+        int rebuildCount = -1;
+        int mode = 0;
+        int trackOffset = 0;
+        int vcaTrackOffset = 0;
+        int folderTrackOffset = 0;
+        int selectedTracksOffset = 0;
+        MediaTrack *vcaLeadTrack = NULL;
+        MediaTrack *folderParentTrack = NULL;
+        size_t numTrackNavigators = 0;
+        
+        bool operator==(const ChannelMapping &other) const
+        {
+            return rebuildCount == other.rebuildCount && mode == other.mode && trackOffset == other.trackOffset && vcaTrackOffset == other.vcaTrackOffset &&
+                   folderTrackOffset == other.folderTrackOffset && selectedTracksOffset == other.selectedTracksOffset &&
+                   vcaLeadTrack == other.vcaLeadTrack && folderParentTrack == other.folderParentTrack && numTrackNavigators == other.numTrackNavigators;
+        }
+    };
+    
+    ChannelMapping trackNavigatorsByTrackMapping_;
+    unordered_map<MediaTrack *, Navigator *> trackNavigatorsByTrack_;
+    
+    ChannelMapping GetChannelMapping()
+    {
+        ChannelMapping mapping;
+        mapping.rebuildCount = rebuildCount_;
+        mapping.mode = currentTrackVCAFolderMode_;
+        mapping.trackOffset = trackOffset_;
+        mapping.vcaTrackOffset = vcaTrackOffset_;
+        mapping.folderTrackOffset = folderTrackOffset_;
+        mapping.selectedTracksOffset = selectedTracksOffset_;
+        mapping.vcaLeadTrack = vcaLeadTrack_;
+        mapping.folderParentTrack = folderParentTrack_;
+        mapping.numTrackNavigators = trackNavigators_.size();
+        
+        return mapping;
+    }
+    
+    // the channel navigator currently showing track, NULL if it isn't on a channel
+    Navigator *GetTrackNavigatorShowingTrack(MediaTrack *track)
+    {
+        ChannelMapping mapping = GetChannelMapping();
+        
+        if ( ! (mapping == trackNavigatorsByTrackMapping_))
+        {
+            trackNavigatorsByTrackMapping_ = mapping;
+            trackNavigatorsByTrack_.clear();
+            
+            for (auto &trackNavigator : trackNavigators_)
+                if (MediaTrack *channelTrack = trackNavigator->GetTrack())
+                    trackNavigatorsByTrack_.emplace(channelTrack, trackNavigator.get()); // the lowest channel wins, as the scan it replaces did
+        }
+        
+        auto it = trackNavigatorsByTrack_.find(track);
+        
+        return it != trackNavigatorsByTrack_.end() ? it->second : NULL;
+    }
+    
+    int GetStructureGeneration();
+    TrackSelection &GetTrackSelection();
+    
+    bool GetIsTrackValid(MediaTrack *track, int listGeneration)
+    {
+        return listGeneration == GetStructureGeneration() || DAW::ValidateTrackPtr(track);
+    }
+    
     void ForceScrollLink()
     {
         // Make sure selected track is visble on the control surface
@@ -3083,25 +4675,20 @@ protected:
         
         if (selectedTrack != NULL)
         {
-            for (auto &trackNavigator : trackNavigators_)
-                if (selectedTrack == trackNavigator->GetTrack())
-                    return;
+            if (GetTrackNavigatorShowingTrack(selectedTrack) != NULL)
+                return;
             
-            for (int i = 1; i <= GetNumTracks(); ++i)
-            {
-                if (selectedTrack == GetTrackFromId(i))
-                {
-                    trackOffset_ = i - 1;
-                    break;
-                }
-            }
+            auto it = trackIndices_.find(selectedTrack);
+            
+            if (it != trackIndices_.end())
+                trackOffset_ = it->second;
             
             trackOffset_ -= targetScrollLinkChannel_;
             
             if (trackOffset_ <  0)
                 trackOffset_ =  0;
             
-            int top = GetNumTracks() - (int) trackNavigators_.size();
+            int top = (int) tracks_.size() - (int) trackNavigators_.size();
             
             if (trackOffset_ >  top)
                 trackOffset_ = top;
@@ -3131,6 +4718,7 @@ public:
     void AdjustSelectedTrackBank(int amount);
     bool GetSynchPages() { return synchPages_; }
     bool GetScrollLink() { return isScrollLinkEnabled_; }
+    int  GetTrackOffset() { return trackOffset_; }
     bool GetFollowMCP() { return followMCP_; }
     int  GetNumTracks() { return CSurf_NumTracks(followMCP_); }
     Navigator *GetMasterTrackNavigator() { return masterTrackNavigator_.get(); }
@@ -3284,15 +4872,9 @@ public:
             return "";
     }
     
-    const vector<MediaTrack *> &GetSelectedTracks()
-    {
-        selectedTracks_.clear();
-        
-        for (int i = 0; i < CountSelectedTracks2(NULL, false); ++i)
-            selectedTracks_.push_back(DAW::GetSelectedTrack(i));
-        
-        return selectedTracks_;
-    }
+    const vector<MediaTrack *> &GetSelectedTracks() { return GetTrackSelection().GetTracks(); }
+    bool GetIsTrackSelected(MediaTrack *track) { return GetTrackSelection().GetIsSelected(track); }
+    TrackStateSnapshot &GetTrackStateSnapshot();
 
     void SetTrackOffset(int trackOffset)
     {
@@ -3391,22 +4973,26 @@ public:
     
     Navigator *GetNavigatorForChannel(int channelNum)
     {
-        for (auto &trackNavigator : trackNavigators_)
-            if (trackNavigator->GetChannelNum() == channelNum)
-                return trackNavigator.get();
+        auto it = trackNavigatorsByChannel_.find(channelNum);
+        
+        if (it != trackNavigatorsByChannel_.end())
+            return it->second;
           
         trackNavigators_.push_back(make_unique<TrackNavigator>(csi_, page_, this, channelNum));
+        trackNavigatorsByChannel_[channelNum] = trackNavigators_.back().get();
             
         return  trackNavigators_.back().get();
     }
     
     Navigator *GetNavigatorForTrack(MediaTrack *track)
     {
-        for (auto &fixedTrackNavigator : fixedTrackNavigators_)
-            if (fixedTrackNavigator->GetTrack() == track)
-                return fixedTrackNavigator.get();
+        auto it = fixedTrackNavigatorsByTrack_.find(track);
+        
+        if (it != fixedTrackNavigatorsByTrack_.end())
+            return it->second;
         
         fixedTrackNavigators_.push_back(make_unique<FixedTrackNavigator>(csi_, page_, track));
+        fixedTrackNavigatorsByTrack_[track] = fixedTrackNavigators_.back().get();
             
         return fixedTrackNavigators_.back().get();
     }
@@ -3417,7 +5003,7 @@ public:
         {
             channelNumber += trackOffset_;
             
-            if (channelNumber < GetNumTracks() && channelNumber < tracks_.size() && DAW::ValidateTrackPtr(tracks_[channelNumber]))
+            if (channelNumber < GetNumTracks() && channelNumber < tracks_.size() && GetIsTrackValid(tracks_[channelNumber], tracksGeneration_))
                 return tracks_[channelNumber];
             else
                 return NULL;
@@ -3428,14 +5014,14 @@ public:
 
             if (vcaLeadTrack_ == NULL)
             {
-                if (channelNumber < vcaTopLeadTracks_.size() && DAW::ValidateTrackPtr(vcaTopLeadTracks_[channelNumber]))
+                if (channelNumber < vcaTopLeadTracks_.size() && GetIsTrackValid(vcaTopLeadTracks_[channelNumber], vcaTracksGeneration_))
                     return vcaTopLeadTracks_[channelNumber];
                 else
                     return NULL;
             }
             else
             {
-                if (channelNumber < vcaSpillTracks_.size() && DAW::ValidateTrackPtr(vcaSpillTracks_[channelNumber]))
+                if (channelNumber < vcaSpillTracks_.size() && GetIsTrackValid(vcaSpillTracks_[channelNumber], vcaTracksGeneration_))
                     return vcaSpillTracks_[channelNumber];
                 else
                     return NULL;
@@ -3447,14 +5033,14 @@ public:
 
             if (folderParentTrack_ == NULL)
             {
-                if (channelNumber < folderTopParentTracks_.size() && DAW::ValidateTrackPtr(folderTopParentTracks_[channelNumber]))
+                if (channelNumber < folderTopParentTracks_.size() && GetIsTrackValid(folderTopParentTracks_[channelNumber], folderTracksGeneration_))
                     return folderTopParentTracks_[channelNumber];
                 else
                     return NULL;
             }
             else
             {
-                if (channelNumber < folderSpillTracks_.size() && DAW::ValidateTrackPtr(folderSpillTracks_[channelNumber]))
+                if (channelNumber < folderSpillTracks_.size() && GetIsTrackValid(folderSpillTracks_[channelNumber], folderTracksGeneration_))
                     return folderSpillTracks_[channelNumber];
                 else
                     return NULL;
@@ -3464,7 +5050,7 @@ public:
         {
             channelNumber += selectedTracksOffset_;
             
-            if (channelNumber < selectedTracks_.size() && DAW::ValidateTrackPtr(selectedTracks_[channelNumber]))
+            if (channelNumber < selectedTracks_.size() && GetIsTrackValid(selectedTracks_[channelNumber], selectedTracksGeneration_))
                 return selectedTracks_[channelNumber];
             else
                 return NULL;
@@ -3488,7 +5074,11 @@ public:
     
     bool GetIsVCASpilled(MediaTrack *track)
     {
-        if (vcaLeadTrack_ == NULL && (DAW::GetTrackGroupMembership(track, "VOLUME_VCA_LEAD") != 0 || DAW::GetTrackGroupMembershipHigh(track, "VOLUME_VCA_LEAD") != 0))
+        trackTopology_.Update(GetStructureGeneration(), followMCP_);
+        
+        if (vcaLeadTrack_ == NULL && trackTopology_.GetHasTrack(track))
+            return trackTopology_.GetIsVCALeader(track);
+        else if (vcaLeadTrack_ == NULL && (DAW::GetTrackGroupMembership(track, "VOLUME_VCA_LEAD") != 0 || DAW::GetTrackGroupMembershipHigh(track, "VOLUME_VCA_LEAD") != 0))
             return true;
         else if (vcaLeadTrack_ == track)
             return true;
@@ -3527,7 +5117,11 @@ public:
 
     bool GetIsFolderSpilled(MediaTrack *track)
     {
-        if (find(folderTopParentTracks_.begin(), folderTopParentTracks_.end(), track) != folderTopParentTracks_.end())
+        trackTopology_.Update(GetStructureGeneration(), followMCP_);
+        
+        if (trackTopology_.GetHasTrack(track))
+            return trackTopology_.GetIsFolderParent(track);
+        else if (find(folderTopParentTracks_.begin(), folderTopParentTracks_.end(), track) != folderTopParentTracks_.end())
             return true;
         else if (GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH") == 1)
             return true;
@@ -3586,13 +5180,7 @@ public:
         OnTrackSelection();
     }
     
-    MediaTrack *GetSelectedTrack()
-    {
-        if (CountSelectedTracks2(NULL, false) != 1)
-            return NULL;
-        else
-            return DAW::GetSelectedTrack(0);
-    }
+    MediaTrack *GetSelectedTrack() { return GetTrackSelection().GetOnlyTrack(); }
     
 //  Page only uses the following:
        
@@ -3625,9 +5213,8 @@ public:
         if (track == GetMasterTrackNavigator()->GetTrack())
             return GetIsNavigatorTouched(GetMasterTrackNavigator(), touchedControl);
         
-        for (auto &trackNavigator : trackNavigators_)
-            if (track == trackNavigator->GetTrack())
-                return GetIsNavigatorTouched(trackNavigator.get(), touchedControl);
+        if (Navigator *trackNavigator = GetTrackNavigatorShowingTrack(track))
+            return GetIsNavigatorTouched(trackNavigator, touchedControl);
  
         if (MediaTrack *selectedTrack = GetSelectedTrack())
              if (track == selectedTrack)
@@ -3661,49 +5248,20 @@ public:
     void RebuildVCASpill()
     {   
         if (currentTrackVCAFolderMode_ != 1)
-            return;
-    
-        vcaTopLeadTracks_.clear();
-        vcaSpillTracks_.clear();
-        
-        unsigned int leadTrackVCALeaderGroup = 0;
-        unsigned int leadTrackVCALeaderGroupHigh = 0;
-        
-        if (vcaLeadTrack_ != NULL)
-        {
-            leadTrackVCALeaderGroup = DAW::GetTrackGroupMembership(vcaLeadTrack_, "VOLUME_VCA_LEAD");
-            leadTrackVCALeaderGroupHigh = DAW::GetTrackGroupMembershipHigh(vcaLeadTrack_, "VOLUME_VCA_LEAD");
-            vcaSpillTracks_.push_back(vcaLeadTrack_);
-        }
-        
-        // Get Visible Tracks
-        for (int tidx = 1; tidx <= GetNumTracks(); ++tidx)
-        {
-            MediaTrack *track = CSurf_TrackFromID(tidx, followMCP_);
-            
-            if (DAW::GetTrackGroupMembership(track, "VOLUME_VCA_LEAD") != 0 && DAW::GetTrackGroupMembership(track, "VOLUME_VCA_FOLLOW") == 0)
-                vcaTopLeadTracks_.push_back(track);
-            
-            if (DAW::GetTrackGroupMembershipHigh(track, "VOLUME_VCA_LEAD") != 0 && DAW::GetTrackGroupMembershipHigh(track, "VOLUME_VCA_FOLLOW") == 0)
-                vcaTopLeadTracks_.push_back(track);
-            
-            if (vcaLeadTrack_ != NULL)
-            {
-                bool isFollower = false;
-                
-                unsigned int leadTrackVCAFollowerGroup = DAW::GetTrackGroupMembership(track, "VOLUME_VCA_FOLLOW");
-                unsigned int leadTrackVCAFollowerGroupHigh = DAW::GetTrackGroupMembershipHigh(track, "VOLUME_VCA_FOLLOW");
-
-                if ((leadTrackVCALeaderGroup     & leadTrackVCAFollowerGroup) ||
-                    (leadTrackVCALeaderGroupHigh & leadTrackVCAFollowerGroupHigh))
-                {
-                    isFollower = true;
-                }
-                
-                if (isFollower)
-                    vcaSpillTracks_.push_back(track);
-            }
-        }
+            return;
+        
+        if (vcaLeadTrack_ != NULL && vcaTracksGeneration_ != GetStructureGeneration() && ! DAW::ValidateTrackPtr(vcaLeadTrack_)) // the only pointer here not fresh from REAPER
+            vcaLeadTrack_ = NULL;
+        
+        trackTopology_.Update(GetStructureGeneration(), followMCP_);
+        
+        vcaTopLeadTracks_ = trackTopology_.GetVCATopLeadTracks();
+        vcaSpillTracks_.clear();
+        
+        if (vcaLeadTrack_ != NULL)
+            trackTopology_.GetVCASpillTracks(vcaLeadTrack_, vcaSpillTracks_);
+        
+        vcaTracksGeneration_ = GetStructureGeneration();
     }
     
     void RebuildFolderTracks()
@@ -3711,47 +5269,48 @@ public:
         if (currentTrackVCAFolderMode_ != 2)
             return;
         
-        folderTopParentTracks_.clear();
-        folderDictionary_.clear();
+        trackTopology_.Update(GetStructureGeneration(), followMCP_);
+        
+        folderTopParentTracks_ = trackTopology_.GetFolderTopParentTracks();
         folderSpillTracks_.clear();
-       
-        vector<vector<MediaTrack*>*> currentDepthTracks;
         
-        for (int i = 1; i <= GetNumTracks(); i++)
-        {
-            MediaTrack* track = CSurf_TrackFromID(i, followMCP_);
+        if (folderParentTrack_ != NULL)
+            trackTopology_.GetFolderSpillTracks(folderParentTrack_, folderSpillTracks_);
+        
+        folderTracksGeneration_ = GetStructureGeneration();
+    }
 
-            if(GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH") == 1)
-            {
-                if(currentDepthTracks.size() == 0)
-                    folderTopParentTracks_.push_back(track);
-                else
-                    currentDepthTracks.back()->push_back(track);
-                
-                folderDictionary_[track].push_back(track);
-                
-                currentDepthTracks.push_back(&folderDictionary_[track]);
-            }
-            else if(GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH") == 0 && currentDepthTracks.size() > 0)
-            {
-                currentDepthTracks.back()->push_back(track);
-            }
-            else if(GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH") < 0 && currentDepthTracks.size() > 0)
-            {
-                currentDepthTracks.back()->push_back(track);
-                
-                int folderBackTrack = (int)-GetMediaTrackInfo_Value(track, "I_FOLDERDEPTH");
-                
-                for(int i = 0; i < folderBackTrack && currentDepthTracks.size() > 0; i++)
-                    currentDepthTracks.pop_back();
-            }
-        }
+    struct ProjectState
+    {
+        int trackOffset = 0;
+        int vcaTrackOffset = 0;
+        int folderTrackOffset = 0;
+        int selectedTracksOffset = 0;
+        MediaTrack *vcaLeadTrack = NULL;
+        MediaTrack *folderParentTrack = NULL;
+    };
+
+    void SaveProjectState(ProjectState &state)
+    {
+        state.trackOffset = trackOffset_;
+        state.vcaTrackOffset = vcaTrackOffset_;
+        state.folderTrackOffset = folderTrackOffset_;
+        state.selectedTracksOffset = selectedTracksOffset_;
+        state.vcaLeadTrack = vcaLeadTrack_;
+        state.folderParentTrack = folderParentTrack_;
+    }
+
+    // The track lists themselves are rebuilt from the new project on the next Page::RebuildTracks
+    void RestoreProjectState(const ProjectState &state)
+    {
+        trackOffset_ = state.trackOffset;
+        vcaTrackOffset_ = state.vcaTrackOffset;
+        folderTrackOffset_ = state.folderTrackOffset;
+        selectedTracksOffset_ = state.selectedTracksOffset;
+        vcaLeadTrack_ = DAW::ValidateTrackPtr(state.vcaLeadTrack) ? state.vcaLeadTrack : NULL;
+        folderParentTrack_ = DAW::ValidateTrackPtr(state.folderParentTrack) ? state.folderParentTrack : NULL;
+    }
 
-        if (folderParentTrack_ != NULL)
-            for (int i = 0; i < folderDictionary_[folderParentTrack_].size(); ++i)
-                folderSpillTracks_.push_back(folderDictionary_[folderParentTrack_][i]);
-     }
-    
     void EnterPage()
     {
         /*
@@ -3792,7 +5351,17 @@ protected:
     unique_ptr<TrackNavigationManager> trackNavigationManager_;
     unique_ptr<ModifierManager> modifierManager_;
     vector<unique_ptr<ControlSurface>> surfaces_;
-    
+
+    struct ProjectState
+    {
+        string projectName; // with the pointer, tells a project apart from a later one that reuses it
+        TrackNavigationManager::ProjectState navigationState;
+        int modifierValue = 0;
+        vector<ControlSurface::ProjectState> surfaceStates;
+    };
+
+    map<ReaProject *, ProjectState> projectStates_;
+
 public:
     Page(CSurfIntegrator *const csi, const char *name, bool followMCP,  bool synchPages, bool isScrollLinkEnabled, bool isScrollSynchEnabled) : csi_(csi), name_(name), trackNavigationManager_(make_unique<TrackNavigationManager>(csi_, this, followMCP, synchPages, isScrollLinkEnabled, isScrollSynchEnabled)), modifierManager_(make_unique<ModifierManager>(csi_, this, (ControlSurface *)NULL)) {}
 
@@ -3836,17 +5405,34 @@ public:
         return trackNavigationManager_->GetIsControlTouched(track, touchedControl);
     }
     
+    // Any change of bank is rendered by each surface as a single frame on its next update
+    void BeginBankTransition()
+    {
+        for (auto &surface : surfaces_)
+            surface->BeginBankTransition();
+    }
+    
     void OnTrackSelection(MediaTrack *track)
     {
+        int trackOffset = trackNavigationManager_->GetTrackOffset();
+        
         trackNavigationManager_->OnTrackSelection();
         
+        if (trackNavigationManager_->GetTrackOffset() != trackOffset)
+            BeginBankTransition();
+        
         for (auto &surface : surfaces_)
             surface->OnTrackSelection(track);
     }
     
     void OnTrackListChange()
     {
+        int trackOffset = trackNavigationManager_->GetTrackOffset();
+        
         trackNavigationManager_->OnTrackListChange();
+        
+        if (trackNavigationManager_->GetTrackOffset() != trackOffset)
+            BeginBankTransition();
     }
     
     void OnTrackSelectionBySurface(MediaTrack *track)
@@ -3863,6 +5449,12 @@ public:
             surface->TrackFXListChanged(track);
     }
     
+    void ReloadZoneFile(const filesystem::path &filePath)
+    {
+        for (auto &surface : surfaces_)
+            surface->GetZoneManager()->ReloadZoneFile(filePath);
+    }
+    
     void EnterPage()
     {
         trackNavigationManager_->EnterPage();
@@ -3884,6 +5476,54 @@ public:
         for (auto &surface : surfaces_)
             surface->OnInitialization();
     }
+
+    void SaveProjectState(ReaProject *project)
+    {
+        ProjectState &state = projectStates_[project];
+
+        state.projectName = DAW::GetProjectName(project); // taken on leaving, so a Save As while it was current still matches
+        trackNavigationManager_->SaveProjectState(state.navigationState);
+        state.modifierValue = modifierManager_->GetModifierValue();
+
+        state.surfaceStates.resize(surfaces_.size());
+
+        for (int i = 0; i < surfaces_.size(); ++i)
+            surfaces_[i]->SaveProjectState(state.surfaceStates[i]);
+    }
+
+    void RestoreProjectState(ReaProject *project)
+    {
+        ProjectState state; // a project seen for the first time starts out on the Home zone
+
+        auto it = projectStates_.find(project);
+        
+        if (it != projectStates_.end() && it->second.projectName == DAW::GetProjectName(project))
+            state = it->second;
+
+        state.surfaceStates.resize(surfaces_.size());
+
+        modifierManager_->SetModifierValue(state.modifierValue);
+        modifierManager_->RecalculateModifiers();
+
+        for (int i = 0; i < surfaces_.size(); ++i)
+            surfaces_[i]->RestoreProjectState(state.surfaceStates[i]);
+
+        trackNavigationManager_->RestoreProjectState(state.navigationState);
+        
+        BeginBankTransition();
+    }
+
+    void PruneProjectStates()
+    {
+        for (auto it = projectStates_.begin(); it != projectStates_.end(); )
+        {
+            // closed tab, the pointer may be reused by a new project, which only the name might give away
+            if ( ! DAW::ValidateProjectPtr(it->first) || it->second.projectName != DAW::GetProjectName(it->first))
+                it = projectStates_.erase(it);
+            else
+                ++it;
+        }
+    }
     
     void SignalStop()
     {
@@ -3917,19 +5557,23 @@ public:
     
     void AdjustBank(const char *zoneName, int amount)
     {
-        if (!strcmp(zoneName, "Track"))
+        int zoneSymbol = FindSymbol(zoneName);
+        
+        if (zoneSymbol == CSISymbol_Track)
             trackNavigationManager_->AdjustTrackBank(amount);
-        else if (!strcmp(zoneName, "VCA"))
+        else if (zoneSymbol == CSISymbol_VCA)
             trackNavigationManager_->AdjustVCABank(amount);
-        else if (!strcmp(zoneName, "Folder"))
+        else if (zoneSymbol == CSISymbol_Folder)
             trackNavigationManager_->AdjustFolderBank(amount);
-        else if (!strcmp(zoneName, "SelectedTracks"))
+        else if (zoneSymbol == CSISymbol_SelectedTracks)
             trackNavigationManager_->AdjustSelectedTracksBank(amount);
-        else if (!strcmp(zoneName, "SelectedTrack"))
+        else if (zoneSymbol == CSISymbol_SelectedTrack)
             trackNavigationManager_->AdjustSelectedTrackBank(amount);
         else
             for (auto &surface : surfaces_)
-                surface->GetZoneManager()->AdjustBank(zoneName, amount);
+                surface->GetZoneManager()->AdjustZoneBank(zoneSymbol, amount);
+        
+        BeginBankTransition();
     }
     
     /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3960,13 +5604,24 @@ public:
     void ToggleScrollLink(int targetChannel) { trackNavigationManager_->ToggleScrollLink(targetChannel); }
     void ToggleSynchPages() { trackNavigationManager_->ToggleSynchPages(); }
     void ToggleFollowMCP() { trackNavigationManager_->ToggleFollowMCP(); }
-    void SetTrackOffset(int offset) { trackNavigationManager_->SetTrackOffset(offset); }
+    void SetTrackOffset(int offset)
+    {
+        int trackOffset = trackNavigationManager_->GetTrackOffset();
+        
+        trackNavigationManager_->SetTrackOffset(offset);
+        
+        if (trackNavigationManager_->GetTrackOffset() != trackOffset)
+            BeginBankTransition();
+    }
+
     MediaTrack *GetSelectedTrack() { return trackNavigationManager_->GetSelectedTrack(); }
     void NextInputMonitorMode(MediaTrack *track) { trackNavigationManager_->NextInputMonitorMode(track); }
     const char *GetAutoModeDisplayName(int modeIndex) { return trackNavigationManager_->GetAutoModeDisplayName(modeIndex); }
     const char *GetGlobalAutoModeDisplayName() { return trackNavigationManager_->GetGlobalAutoModeDisplayName(); }
     const char *GetCurrentInputMonitorMode(MediaTrack *track) { return trackNavigationManager_->GetCurrentInputMonitorMode(track); }
     const vector<MediaTrack *> &GetSelectedTracks() { return trackNavigationManager_->GetSelectedTracks(); }
+    bool GetIsTrackSelected(MediaTrack *track) { return trackNavigationManager_->GetIsTrackSelected(track); }
+    TrackStateSnapshot &GetTrackStateSnapshot() { return trackNavigationManager_->GetTrackStateSnapshot(); }
     
      
     /*
@@ -4027,20 +5682,247 @@ public:
    */
 
 //*
-    void Run()
+    // CSurfIntegrator::Run calls RebuildTracks, then has the input handled, then calls Run for the feedback
+    void RebuildTracks()
     {
         trackNavigationManager_->RebuildTracks();
         trackNavigationManager_->RebuildVCASpill();
         trackNavigationManager_->RebuildFolderTracks();
         trackNavigationManager_->RebuildSelectedTracks();
-        
+    }
+    
+    void Run()
+    {
+        // hold and repeat actions write to REAPER, so they go before the snapshot is taken
         for (auto &surface : surfaces_)
-            surface->HandleExternalInput();
+            surface->RunDeferredActions();
+        
+        TrackStateSnapshotScope trackStateSnapshotScope(GetTrackStateSnapshot());
         
         for (auto &surface : surfaces_)
             surface->RequestUpdate();
     }
 //*/
+    
+    // also called from the I/O timer between Runs, feedback is only evaluated in Run
+    void HandleExternalInput()
+    {
+        for (auto &surface : surfaces_)
+            surface->HandleExternalInput();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class BackgroundFileWriter
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Writes whole files on a worker thread, the main thread only hands over the finished contents.
+    // A file queued again before it was written is only written once, with the latest contents.
+private:
+    thread thread_;
+    mutex mutex_;
+    condition_variable wake_;
+    bool shouldStop_ = false;
+    
+    map<string, string> pendingFiles_; // path -> contents
+    
+    void Run()
+    {
+        unique_lock<mutex> lock(mutex_);
+        
+        while (true)
+        {
+            wake_.wait(lock, [this] { return shouldStop_ || ! pendingFiles_.empty(); });
+            
+            if (pendingFiles_.empty()) // stopping, and everything queued has been written
+                return;
+            
+            auto it = pendingFiles_.begin();
+            string path = it->first;
+            string contents = move(it->second);
+            pendingFiles_.erase(it);
+            
+            lock.unlock();
+            
+            if (FILE *file = fopenUTF8(path.c_str(), "wb"))
+            {
+                fwrite(contents.data(), 1, contents.size(), file);
+                fclose(file);
+            }
+            
+            lock.lock();
+        }
+    }
+    
+public:
+    ~BackgroundFileWriter()
+    {
+        if (thread_.joinable())
+        {
+            {
+                lock_guard<mutex> lock(mutex_);
+                shouldStop_ = true;
+            }
+            
+            wake_.notify_one();
+            thread_.join();
+        }
+    }
+    
+    void QueueFile(const string &path, string &&contents)
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            pendingFiles_[path] = move(contents);
+            
+            if ( ! thread_.joinable())
+                thread_ = thread(&BackgroundFileWriter::Run, this);
+        }
+        
+        wake_.notify_one();
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FXParamInfo
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string name;
+    int numSteps = 0; // 0 = continuous
+    string minValue;  // formatted by the plugin, empty if it can't
+    string maxValue;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct FXParamMetadata
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    string ident;
+    string version;
+    vector<FXParamInfo> params;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class FXParamCache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Plugin parameter lists, kept in CSI/FXParamCache so Learn and the raw FX files don't enumerate
+    // a plugin with thousands of params on every open. An entry is keyed by the identifier REAPER
+    // resolves for the plugin (fx_ident), never by the FX name, which the user can rename. The plugin
+    // file is stat'ed when the entry is loaded, after that only a changed param count sends it back
+    // to the plugin. JSFX aren't cached, their slider names change with the script. The first time an
+    // instance is seen its names are spot checked against the entry, a plugin whose names differ per
+    // instance (ReaLearn, samplers) is marked dynamic and always read live.
+    // A lookup never enumerates a plugin, a miss is read live and the plugin is queued: Run fills
+    // its entry FXParamsPerRun params at a time.
+private:
+    map<string, unique_ptr<FXParamMetadata>> entries_;
+    set<string> dynamicIdents_;
+    set<string> checkedInstances_; // FX GUIDs
+    BackgroundFileWriter fileWriter_;
+    
+    struct PendingEntry
+    {
+        MediaTrack *track = NULL;
+        int fxIndex = 0; // where the FX was when queued, checked against fxGUID on each Run
+        string fxGUID;
+        int numParams = 0;
+        FXParamMetadata metadata; // params enumerated so far
+    };
+    
+    map<string, PendingEntry> pendingEntries_; // by ident
+    
+    static const int FXParamsPerRun = 32;
+    
+    static bool GetIdent(MediaTrack *track, int fxIndex, string &ident);
+    static string GetVersion(const string &ident, int numParams);
+    static string GetFilePath(const string &ident);
+    static bool Read(const string &ident, FXParamMetadata &metadata);
+    void Write(const FXParamMetadata &metadata);
+    static void GetParamInfo(MediaTrack *track, int fxIndex, int paramIndex, FXParamInfo &info);
+    static int FindFX(MediaTrack *track, int fxIndex, const string &fxGUID);
+    void QueueEntry(MediaTrack *track, int fxIndex, const string &ident, const string &version, int numParams);
+    bool GetIsInstanceChecked(MediaTrack *track, int fxIndex);
+    bool GetIsInstanceDynamic(MediaTrack *track, int fxIndex, const FXParamMetadata &metadata);
+    
+public:
+    // NULL when the plugin isn't cached (yet), resolve it once and index it when reading more than one param
+    const FXParamMetadata *GetMetadata(MediaTrack *track, int fxIndex);
+    
+    void Run();
+    
+    const char *GetParamName(MediaTrack *track, int fxIndex, int paramIndex, char *buf, int bufsz)
+    {
+        return GetParamName(GetMetadata(track, fxIndex), track, fxIndex, paramIndex, buf, bufsz);
+    }
+    
+    static const char *GetParamName(const FXParamMetadata *metadata, MediaTrack *track, int fxIndex, int paramIndex, char *buf, int bufsz)
+    {
+        buf[0] = 0;
+        
+        if (metadata != NULL && paramIndex >= 0 && paramIndex < (int)metadata->params.size())
+            lstrcpyn_safe(buf, metadata->params[paramIndex].name.c_str(), bufsz);
+        else
+            TrackFX_GetParamName(track, fxIndex, paramIndex, buf, bufsz);
+        
+        return buf;
+    }
+    
+    int GetNumSteps(MediaTrack *track, int fxIndex, int paramIndex)
+    {
+        const FXParamMetadata *metadata = GetMetadata(track, fxIndex);
+        
+        if (metadata != NULL && paramIndex >= 0 && paramIndex < (int)metadata->params.size())
+            return metadata->params[paramIndex].numSteps;
+        
+        if ( ! DAW::ValidateTrackPtr(track) || paramIndex < 0 || paramIndex >= TrackFX_GetNumParams(track, fxIndex))
+            return 0;
+        
+        FXParamInfo info;
+        GetParamInfo(track, fxIndex, paramIndex, info);
+        return info.numSteps;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class ResourceFileWatcher
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Reports CSI.ini, Surface.txt and .zon files written under the CSI folder since the last call,
+    // so an edit reloads only what it touches. inotify on Linux, elsewhere a worker thread compares
+    // the file times every couple of seconds and the main thread only picks up what it found.
+private:
+    string folder_;
+    
+#ifdef __linux__
+    int inotifyFd_ = -1;
+    map<int, string> watchedFolders_; // watch descriptor -> folder
+    
+    void AddWatches(const string &folder);
+#else
+    thread thread_;
+    mutex mutex_;
+    condition_variable wake_;
+    bool shouldStop_ = false;
+    set<string> changedFiles_; // found by the scan thread, not yet picked up
+    
+    map<string, filesystem::file_time_type> fileTimes_; // scan thread only
+    
+    void Run(string folder);
+    void Scan(const string &folder, set<string> *changedFiles);
+#endif
+    
+    static bool GetIsWatchedFile(const filesystem::path &filePath);
+    
+public:
+    ~ResourceFileWatcher()
+    {
+        Stop();
+    }
+    
+    void Start(const string &folder);
+    void Stop();
+    void GetChangedFiles(set<string> &changedFiles); // lexically normal paths
 };
 
 static const int s_tickCounts_[] = { 250, 235, 220, 205, 190, 175, 160, 145, 130, 115, 100, 90, 80, 70, 60, 50, 45, 40, 35, 30, 25, 20, 20, 20 };
@@ -4064,6 +5946,48 @@ private:
     bool shouldRun_ = true;
     bool isShuttingDown_ = false;
     
+    // Input is also polled from a plain WM_TIMER in between REAPER's Run calls (~30 Hz), so a press or a fader move
+    // (rate limited, see ControlSurface::GetShouldParkInput) can reach REAPER without waiting for the next Run. It's best effort, Windows rounds the interval up to its timer resolution
+    // (10 - 16 ms) and only delivers the timer when the message queue is otherwise idle. Feedback and the output
+    // queues stay on the Run schedule.
+    UINT_PTR ioTimerId_ = 0;
+    bool isHandlingInput_ = false; // set by Run and by the timer, whichever is reading input
+    bool isPollingBetweenRuns_ = false;
+    bool isTrackListDirty_ = false; // track lists are only rebuilt in Run, so input waits for it after a change
+    
+    int structureGeneration_ = 0; // bumped when tracks are added, removed or renamed, or an FX chain changes
+    
+    FXParamCache fxParamCache_;
+    BackgroundFileWriter rawFXFileWriter_;
+    
+    TrackSelection trackSelection_;
+    TrackStateSnapshot trackStateSnapshot_;
+    
+    ResourceFileWatcher resourceFileWatcher_;
+    string iniFileContents_; // what Init read, the Preferences dialog rewrites CSI.ini unchanged
+    
+    void ReloadChangedFiles();
+    
+    // Init runs again on every reset and reload, a surface IO that already exists keeps its ports
+    bool GetHasSurfaceIO(const char *name)
+    {
+        for (auto &io : midiSurfacesIO_)
+            if ( ! strcmp(io->GetName(), name))
+                return true;
+        
+        for (auto &io : oscSurfacesIO_)
+            if ( ! strcmp(io->GetName(), name))
+                return true;
+        
+        return false;
+    }
+    
+    static void CALLBACK IOTimerProc(HWND hwnd, UINT msg, UINT_PTR timerId, DWORD time);
+    void StartIOTimer();
+    void StopIOTimer();
+    void HandleIOTimer();
+    void HandlePageInput();
+    
     ReaProject* currentProject_ = NULL;
     
     // these are offsets to be passed to projectconfig_var_addr() when needed in order to get the actual pointers
@@ -4114,6 +6038,7 @@ public:
         
         // We want to stop polling
         shouldRun_ = false;
+        StopIOTimer();
         
         ResetWidgets();
 
@@ -4192,12 +6117,26 @@ public:
     
     void OnTrackSelection(MediaTrack *track) override
     {
+        trackSelection_.SetDirty();
+        
         if (pages_.size() > currentPageIndex_ && pages_[currentPageIndex_])
             pages_[currentPageIndex_]->OnTrackSelection(track);
     }
     
+    void SetSurfaceSelected(MediaTrack *track, bool selected) override
+    {
+        trackSelection_.SetDirty();
+    }
+    
+    // true while the I/O timer is reading input in between Runs
+    bool GetIsPollingBetweenRuns() { return isPollingBetweenRuns_; }
+    
     void SetTrackListChange() override
     {
+        isTrackListDirty_ = true;
+        structureGeneration_++;
+        trackSelection_.SetDirty();
+        
         if (pages_.size() > currentPageIndex_ && pages_[currentPageIndex_])
             pages_[currentPageIndex_]->OnTrackListChange();
     }
@@ -4277,59 +6216,77 @@ public:
             return false;
     }
     
+    void SetTrackTitle(MediaTrack *track, const char *title) override
+    {
+        structureGeneration_++;
+    }
+    
+    int GetStructureGeneration() { return structureGeneration_; }
+    TrackSelection &GetTrackSelection() { return trackSelection_; }
+    TrackStateSnapshot &GetTrackStateSnapshot() { return trackStateSnapshot_; }
+    
+    FXParamCache &GetFXParamCache() { return fxParamCache_; }
+    
     void TrackFXListChanged(MediaTrack *track)
     {
+        structureGeneration_++;
+        
         for (auto &page : pages_)
             page->TrackFXListChanged(track);
         
         if (g_fxParamsWrite)
         {
+            // only the names are captured here, the files are written by rawFXFileWriter_
             char fxName[MEDBUF];
             
             for (int i = 0; i < TrackFX_GetCount(track); ++i)
             {
                 TrackFX_GetFXName(track, i, fxName, sizeof(fxName));
-                FILE *fxFile = NULL;
-                                
-                if (g_fxParamsWrite)
-                {
-                    string fxNameNoBadChars(fxName);
-                    ReplaceAllWith(fxNameNoBadChars, s_BadFileChars, "_");
-
-                    fxFile = fopenUTF8((string(GetResourcePath()) + "/CSI/ZoneRawFXFiles/" + fxNameNoBadChars + ".txt").c_str(), "wb");
-                    
-                    if (fxFile)
-                        fprintf(fxFile, "Zone \"%s\"\n", fxName);
-                }
-
+                
+                string fxNameNoBadChars(fxName);
+                ReplaceAllWith(fxNameNoBadChars, s_BadFileChars, "_");
+                
+                string contents = "Zone \"" + string(fxName) + "\"\n";
+                
+                char paramName[MEDBUF];
+                
+                // JSFX, dynamic and not yet cached plugins have no entry, GetParamName reads those live
+                const FXParamMetadata *metadata = fxParamCache_.GetMetadata(track, i);
+                
                 for (int j = 0; j < TrackFX_GetNumParams(track, i); ++j)
-                {
-                    char fxParamName[MEDBUF];
-                    TrackFX_GetParamName(track, i, j, fxParamName, sizeof(fxParamName));
- 
-                    if (fxFile)
-                        fprintf(fxFile, "\tFXParam %d \"%s\"\n", j, fxParamName);
-                        
-                    /* step sizes
-                    double stepOut = 0;
-                    double smallstepOut = 0;
-                    double largestepOut = 0;
-                    bool istoggleOut = false;
-                    TrackFX_GetParameterStepSizes(track, i, j, &stepOut, &smallstepOut, &largestepOut, &istoggleOut);
-
-                    ShowConsoleMsg(("\n\n" + to_string(j) + " - \"" + string(fxParamName) + "\"\t\t\t\t Step = " +  to_string(stepOut) + " Small Step = " + to_string(smallstepOut)  + " LargeStep = " + to_string(largestepOut)  + " Toggle Out = " + (istoggleOut == 0 ? "false" : "true")).c_str());
-                    */
-                }
+                    contents += "\tFXParam " + to_string(j) + " \"" + FXParamCache::GetParamName(metadata, track, i, j, paramName, sizeof(paramName)) + "\"\n";
                 
-                if (fxFile)
-                {
-                    fprintf(fxFile,"ZoneEnd");
-                    fclose(fxFile);
-                }
+                contents += "ZoneEnd";
+                
+                rawFXFileWriter_.QueueFile(string(GetResourcePath()) + "/CSI/ZoneRawFXFiles/" + fxNameNoBadChars + ".txt", move(contents));
             }
         }
     }
     
+    // Switching project tabs swaps the cached per project surface state instead of reinitializing,
+    // widgets keep their last sent values so only what actually differs goes out to the hardware
+    void SwitchProject(ReaProject *previousProject, ReaProject *project)
+    {
+        structureGeneration_++; // the track lists still hold the previous project's tracks
+        trackSelection_.SetDirty();
+        
+        // the project's load may have sent the devices anything, the widgets' own last values still spare repeats
+        for (auto &io : midiSurfacesIO_)
+            io->InvalidateShadow();
+        
+        for (auto &io : oscSurfacesIO_)
+            io->InvalidateShadow();
+        
+        for (auto &page : pages_)
+        {
+            if (DAW::ValidateProjectPtr(previousProject))
+                page->SaveProjectState(previousProject);
+
+            page->PruneProjectStates();
+            page->RestoreProjectState(project);
+        }
+    }
+    
     const char *GetTCPFXParamName(MediaTrack *track, int fxIndex, int paramIndex, char *buf, int bufsz)
     {
         buf[0]=0;
@@ -4347,12 +6304,29 @@ public:
 
         if (currentProject_ != currentProject)
         {
+            if (currentProject_ == NULL)
+                DAW::SendCommandMessage(REAPER__CONTROL_SURFACE_REFRESH_ALL_SURFACES);
+            else
+                SwitchProject(currentProject_, currentProject);
+
             currentProject_ = currentProject;
-            DAW::SendCommandMessage(REAPER__CONTROL_SURFACE_REFRESH_ALL_SURFACES);
+        }
+        
+        if (shouldRun_)
+        {
+            ReloadChangedFiles();
+            fxParamCache_.Run();
         }
         
         if (shouldRun_ && pages_.size() > currentPageIndex_ && pages_[currentPageIndex_]) {
+            g_traceRing.Record(TraceEvent_TickBegin, 0, 0, 0.0);
+            
+            trackSelection_.Validate();
+            
             try {
+                isTrackListDirty_ = false;
+                pages_[currentPageIndex_]->RebuildTracks();
+                HandlePageInput();
                 pages_[currentPageIndex_]->Run();
             } catch (const ReloadPluginException& e) {
                 if (g_debugLevel >= DEBUG_LEVEL_NOTICE) LogToConsole(256, "[NOTICE] RELOADING: : %s\n", e.what());
@@ -4361,6 +6335,8 @@ public:
                 LogToConsole(256, "[ERROR] # CSurfIntegrator::RUN: %s\n", e.what());
                 LogStackTraceToConsole();
             }
+            
+            g_traceRing.Record(TraceEvent_TickEnd, 0, 0, 0.0);
         }
         
 
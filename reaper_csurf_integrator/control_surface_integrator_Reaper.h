@@ -139,6 +139,15 @@ public:
     static MediaTrack *GetSelectedTrack(int seltrackidx) { return ::GetSelectedTrack(NULL, seltrackidx); }
 
     static bool ValidateTrackPtr(MediaTrack *track) { return ::ValidatePtr(track, "MediaTrack*"); }
+    static bool ValidateProjectPtr(ReaProject *project) { return ::ValidatePtr(project, "ReaProject*"); }
+    
+    static string GetProjectName(ReaProject *project)
+    {
+        char buf[MEDBUF];
+        buf[0] = 0;
+        ::GetProjectName(project, buf, sizeof(buf));
+        return buf;
+    }
 
     static bool CanUndo()
     {
@@ -342,4 +351,38 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DAWWriteTransaction
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Scope a multi-track write in one of these, REAPER then repaints the TCP/mixer once
+    // when it ends and the whole change lands in a single undo point.
+private:
+    const char *const undoDescription_;
+    int const undoFlags_;
+    
+public:
+    DAWWriteTransaction(const char *undoDescription, int undoFlags = UNDO_STATE_TRACKCFG) : undoDescription_(undoDescription), undoFlags_(undoFlags)
+    {
+        ::PreventUIRefresh(1);
+        ::Undo_BeginBlock2(NULL);
+    }
+    
+    ~DAWWriteTransaction()
+    {
+        ::Undo_EndBlock2(NULL, undoDescription_, undoFlags_);
+        ::PreventUIRefresh(-1);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class DAWUIRefreshBatch
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // For multi-track changes REAPER doesn't undo, e.g. selection: one repaint when it ends, no undo point.
+public:
+    DAWUIRefreshBatch() { ::PreventUIRefresh(1); }
+    ~DAWUIRefreshBatch() { ::PreventUIRefresh(-1); }
+};
+
 #endif /* control_surface_integrator_Reaper_h */
@@ -273,6 +273,7 @@ struct SurfaceFXTemplate
 };
 
 static vector<unique_ptr<SurfaceFXTemplate>> s_surfaceFXTemplates;
+static map<ZoneManager *, SurfaceFXTemplate *> s_surfaceFXTemplatesByZoneManager;
 
 SurfaceFXTemplate *GetSurfaceFXTemplate(HWND hwnd)
 {
@@ -285,11 +286,9 @@ SurfaceFXTemplate *GetSurfaceFXTemplate(HWND hwnd)
 
 SurfaceFXTemplate *GetSurfaceFXTemplate(ZoneManager *zoneManager)
 {
-    for (auto &surfaceFXTemplate : s_surfaceFXTemplates)
-        if (surfaceFXTemplate->zoneManager == zoneManager)
-            return surfaceFXTemplate.get();
+    auto it = s_surfaceFXTemplatesByZoneManager.find(zoneManager);
     
-    return NULL;
+    return it != s_surfaceFXTemplatesByZoneManager.end() ? it->second : NULL;
 }
 
 static FXCell *GetCell(SurfaceFXTemplate *t, Widget *widget, int modifier)
@@ -1174,7 +1173,7 @@ static void FillParams(HWND hwndDlg, SurfaceFXTemplate *t, Widget *widget, int m
         ClearParams(hwndDlg);
     else
     {
-        TrackFX_GetParamName(s_focusedTrack, s_fxSlot, s_lastTouchedParamNum, buf, sizeof(buf));
+        t->zoneManager->GetCSI()->GetFXParamCache().GetParamName(s_focusedTrack, s_fxSlot, s_lastTouchedParamNum, buf, sizeof(buf));
         SetDlgItemText(hwndDlg, IDC_FXParamNameEdit, buf);
         FillAdvancedParams(hwndDlg, t, widget, modifier);
     }
@@ -1275,7 +1274,18 @@ static void HandleAssigment(SurfaceFXTemplate *t, Widget *widget, int modifier,
             }
         }
         
-        TrackFX_GetParamName(s_focusedTrack, s_fxSlot, paramIdx, buf, sizeof(buf));
+        FXParamCache &fxParamCache = zoneManager->GetCSI()->GetFXParamCache();
+        
+        fxParamCache.GetParamName(s_focusedTrack, s_fxSlot, paramIdx, buf, sizeof(buf));
+        
+        int numSteps = fxParamCache.GetNumSteps(s_focusedTrack, s_fxSlot, paramIdx);
+        
+        if (numSteps >= g_minNumParamSteps && numSteps <= g_maxNumParamSteps)
+        {
+            vector<double> steps;
+            GetParamStepsValues(steps, numSteps);
+            paramContext->SetStepValues(steps);
+        }
         
         char fullWidgetName[MEDBUF];
         snprintf(fullWidgetName, sizeof(fullWidgetName), "%s%s%d",  t->nameWidget, cell->suffix.c_str(), cell->channel);
@@ -2037,6 +2047,7 @@ static WDL_DLGRET dlgProcLearnFX(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM
         case WM_CLOSE:
         {
             s_surfaceFXTemplates.clear();
+            s_surfaceFXTemplatesByZoneManager.clear();
 
             if (zoneManager)
                 zoneManager->ClearLearnFocusedFXZone();
@@ -2171,16 +2182,9 @@ static WDL_DLGRET dlgProcLearnFX(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM
     return 0;
 }
 
+// Only called while zoneManager has a Learn zone, ie. while the Learn window is open
 void WidgetMoved(ZoneManager *zoneManager, Widget *widget, int modifier)
 {
-    SurfaceFXTemplate *t = GetSurfaceFXTemplate(zoneManager);
-    
-    if ( ! t)
-        return;
-    
-    if ( ! t->hwnd)
-        return;
-    
     if (s_focusedTrack == NULL)
         return;
     
@@ -2190,8 +2194,15 @@ void WidgetMoved(ZoneManager *zoneManager, Widget *widget, int modifier)
     if (zoneManager->GetLearnedFocusedFXZone() == NULL)
         return;
     
-    vector<Widget *> widgets = zoneManager->GetLearnedFocusedFXZone()->GetWidgets();
-    if (find(widgets.begin(), widgets.end(), widget) == widgets.end())
+    if ( ! zoneManager->GetLearnedFocusedFXZone()->GetHasWidget(widget))
+        return;
+    
+    SurfaceFXTemplate *t = GetSurfaceFXTemplate(zoneManager);
+    
+    if ( ! t)
+        return;
+    
+    if ( ! t->hwnd)
         return;
 
     s_currentWidget = widget;
@@ -2243,6 +2254,7 @@ static void InitLearnFocusedFXDialog(ZoneManager *zoneManager)
     s_surfaceFXTemplates.push_back(make_unique<SurfaceFXTemplate>(zoneManager));
     
     SurfaceFXTemplate *t = s_surfaceFXTemplates.back().get();
+    s_surfaceFXTemplatesByZoneManager[zoneManager] = t;
     LoadTemplates(t);
     
     t->hwnd = CreateDialog(g_hInst, MAKEINTRESOURCE(IDD_DIALOG_LearnFX), g_hwnd, dlgProcLearnFX);
@@ -2334,9 +2346,13 @@ void CloseFocusedFXDialog()
         SendMessage(s_hwndLearnFXDlg, WM_CLOSE, 0, 0);
 }
 
-void UpdateLearnWindow(ZoneManager *zoneManager)
+// Called when REAPER reports a last touched FX or FX param change
+void UpdateLearnWindow()
 {
-    SurfaceFXTemplate *t = GetSurfaceFXTemplate(zoneManager);
+    if (s_hwndLearnFXDlg == NULL)
+        return;
+    
+    SurfaceFXTemplate *t = GetSurfaceFXTemplate(s_hwndLearnFXDlg);
 
     if ( ! t)
         return;
@@ -2362,7 +2378,7 @@ void UpdateLearnWindow(ZoneManager *zoneManager)
             if (IsWindowVisible(GetDlgItem(t->hwnd, IDC_Assign)))
             {
                 char buf[MEDBUF];
-                TrackFX_GetParamName(DAW::GetTrack(trackNumberOut), fxNumberOut, paramNumberOut, buf, sizeof(buf));
+                t->zoneManager->GetCSI()->GetFXParamCache().GetParamName(DAW::GetTrack(trackNumberOut), fxNumberOut, paramNumberOut, buf, sizeof(buf));
                 
                 SetDlgItemText(t->hwnd, IDC_AssignFXParamDisplay, buf);
                 EnableWindow(GetDlgItem(t->hwnd, IDC_Assign), true);
@@ -2373,16 +2389,7 @@ void UpdateLearnWindow(ZoneManager *zoneManager)
 
 void InitBlankLearnFocusedFXZone(ZoneManager *zoneManager, Zone *fxZone, MediaTrack *track, int fxSlot)
 {
-    SurfaceFXTemplate *t = NULL;
-    
-    for (auto &surfaceFXTemplate : s_surfaceFXTemplates)
-    {
-        if (surfaceFXTemplate->zoneManager == zoneManager)
-        {
-            t = surfaceFXTemplate.get();
-            break;
-        }
-    }
+    SurfaceFXTemplate *t = GetSurfaceFXTemplate(zoneManager);
     
     if ( ! t)
         return;
@@ -2473,6 +2480,7 @@ struct SurfaceLine
     int outPort = 0;
     int surfaceRefreshRate = s_surfaceDefaultRefreshRate;
     int surfaceMaxSysExMessagesPerRun = s_surfaceDefaultMaxSysExMessagesPerRun;
+    int surfaceMaxBytesPerSecond = 0; // only set by hand in CSI.ini, kept when the dialog writes it back
     int surfaceMaxPacketsPerRun = s_surfaceDefaultMaxPacketsPerRun;
     string remoteDeviceIP;
     
@@ -3014,6 +3022,7 @@ static WDL_DLGRET dlgProcAdvancedSetup(HWND hwndDlg, UINT uMsg, WPARAM wParam, L
             CheckDlgButton(hwndDlg, IDC_CHECK_ShowRawInput, g_surfaceRawInDisplay);
             CheckDlgButton(hwndDlg, IDC_CHECK_ShowInput, g_surfaceInDisplay);
             CheckDlgButton(hwndDlg, IDC_CHECK_ShowOutput, g_surfaceOutDisplay);
+            CheckDlgButton(hwndDlg, IDC_CHECK_ShowLatency, g_surfaceLatencyDisplay);
             CheckDlgButton(hwndDlg, IDC_CHECK_WriteFXParams, g_fxParamsWrite);
         }
             
@@ -3058,6 +3067,11 @@ static WDL_DLGRET dlgProcAdvancedSetup(HWND hwndDlg, UINT uMsg, WPARAM wParam, L
                     }
                     break;
 
+                case IDC_BUTTON_SaveTrace:
+                    if (HIWORD(wParam) == BN_CLICKED)
+                        SaveTrace();
+                    break;
+                    
                 case ID_BUTTON_AddBroadcaster:
                     if (HIWORD(wParam) == BN_CLICKED)
                     {
@@ -3279,6 +3293,7 @@ static WDL_DLGRET dlgProcAdvancedSetup(HWND hwndDlg, UINT uMsg, WPARAM wParam, L
                         g_surfaceRawInDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowRawInput) != 0;
                         g_surfaceInDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowInput) != 0;
                         g_surfaceOutDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowOutput) != 0;
+                        g_surfaceLatencyDisplay = IsDlgButtonChecked(hwndDlg, IDC_CHECK_ShowLatency) != 0;
                         g_fxParamsWrite = IsDlgButtonChecked(hwndDlg, IDC_CHECK_WriteFXParams) != 0;
                         
                         TransferBroadcasters(s_broadcasters, s_pages[s_pageIndex]->broadcasters);
@@ -3751,7 +3766,7 @@ WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPar
                         {
                             if (const char *surfaceChannelCountProp = pList.get_prop(PropertyType_SurfaceChannelCount))
                             {
-                                if ( ! strcmp(surfaceTypeProp, s_MidiSurfaceToken) && tokens.size() == 7)
+                                if ( ! strcmp(surfaceTypeProp, s_MidiSurfaceToken) && (tokens.size() == 7 || tokens.size() == 8))
                                 {
                                     if (pList.get_prop(PropertyType_MidiInput) != NULL &&
                                         pList.get_prop(PropertyType_MidiOutput) != NULL &&
@@ -3760,6 +3775,9 @@ WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPar
                                     {
                                         s_surfaces.push_back(make_unique<SurfaceLine>(surfaceTypeProp, surfaceNameProp, atoi(surfaceChannelCountProp),                                                                       atoi(pList.get_prop(PropertyType_MidiInput)), atoi(pList.get_prop(PropertyType_MidiOutput)), atoi(pList.get_prop(PropertyType_MIDISurfaceRefreshRate)), atoi(pList.get_prop(PropertyType_MaxMIDIMesssagesPerRun))));
                                         
+                                        if (const char *maxBytesPerSecondProp = pList.get_prop(PropertyType_MaxMIDIBytesPerSecond))
+                                            s_surfaces.back()->surfaceMaxBytesPerSecond = atoi(maxBytesPerSecondProp);
+                                        
                                         AddListEntry(hwndDlg, s_surfaces.back().get()->name, IDC_LIST_Surfaces);
                                     }
                                 }
@@ -3972,6 +3990,9 @@ WDL_DLGRET dlgProcMainConfig(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPar
                         
                         int maxSysExMessagesPerRun = surface->surfaceMaxSysExMessagesPerRun < 1 ? s_surfaceDefaultMaxSysExMessagesPerRun : surface->surfaceMaxSysExMessagesPerRun;
                         fprintf(iniFile, "%s=%d ", plist.string_from_prop(PropertyType_MaxMIDIMesssagesPerRun), maxSysExMessagesPerRun);
+                        
+                        if (surface->surfaceMaxBytesPerSecond > 0)
+                            fprintf(iniFile, "%s=%d ", plist.string_from_prop(PropertyType_MaxMIDIBytesPerSecond), surface->surfaceMaxBytesPerSecond);
                     }
                     
                     else if (type == s_OSCSurfaceToken || type == s_OSCX32SurfaceToken)
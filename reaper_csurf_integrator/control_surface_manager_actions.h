@@ -60,7 +60,7 @@ public:
 
         if (tokens.size() == 1)
         {
-            context->GetSurface()->SendOSCMessage(tokens[0].c_str());
+            context->GetSurface()->SendOSCMessage(tokens[0].c_str(), context->GetStringParamSymbol());
             return;
         }
         
@@ -74,7 +74,7 @@ public:
             const double dv = strtod(t1, (char **)&t1e);
             if (t1e && t1e != t1 && !*t1e)
             {
-                context->GetSurface()->SendOSCMessage(tokens[0].c_str(), dv);
+                context->GetSurface()->SendOSCMessage(tokens[0].c_str(), context->GetStringParamSymbol(), dv);
                 return;
             }
         }
@@ -83,12 +83,12 @@ public:
             const int v = (int)strtol(t1, (char **)&t1e, 10);
             if (t1e && t1e != t1 && !*t1e)
             {
-                context->GetSurface()->SendOSCMessage(tokens[0].c_str(), v);
+                context->GetSurface()->SendOSCMessage(tokens[0].c_str(), context->GetStringParamSymbol(), v);
                 return;
             }
         }
 
-        context->GetSurface()->SendOSCMessage(tokens[0].c_str(), tokens[1].c_str());
+        context->GetSurface()->SendOSCMessage(tokens[0].c_str(), context->GetStringParamSymbol(), tokens[1].c_str());
     }
 };
 
@@ -747,7 +747,7 @@ public:
     
     virtual void RequestUpdate(ActionContext *context) override
     {
-        if (context->GetSurface()->GetZoneManager()->GetIsGoZoneActive(context->GetStringParam()))
+        if (context->GetSurface()->GetZoneManager()->GetIsGoZoneActive(context->GetStringParamSymbol()))
             context->UpdateWidgetValue(1.0);
         else
             context->UpdateWidgetValue(0.0);
@@ -769,7 +769,7 @@ public:
         else
             context->GetSurface()->GetZoneManager()->DeclareGoZone(name);
 
-        bool isActive = context->GetSurface()->GetZoneManager()->GetIsGoZoneActive(context->GetStringParam());
+        bool isActive = context->GetSurface()->GetZoneManager()->GetIsGoZoneActive(context->GetStringParamSymbol());
         DAW::UpdateView(name, isActive, NULL);
 
     }
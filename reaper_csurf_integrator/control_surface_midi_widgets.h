@@ -85,6 +85,8 @@ public:
     virtual ~Fader14Bit_Midi_CSIMessageGenerator() {}
     Fader14Bit_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : Midi_CSIMessageGenerator(csi, widget) {}
     
+    virtual bool GetIsAbsolute() override { return true; }
+    
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
     {
         widget_->GetZoneManager()->DoAction(widget_, int14ToNormalized(midiMessage->midi_message[2], midiMessage->midi_message[1]));
@@ -120,87 +122,159 @@ public:
     virtual ~Fader7Bit_Midi_CSIMessageGenerator() {}
     Fader7Bit_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : Midi_CSIMessageGenerator(csi, widget) {}
     
+    virtual bool GetIsAbsolute() override { return true; }
+    
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
     {
         widget_->GetZoneManager()->DoAction(widget_, midiMessage->midi_message[2] / 127.0);
     }
 };
 
+// Timing based acceleration for encoders that only ever send +/-1, opted into per widget with a trailing
+// TimeAccelerated token, e.g. "Encoder b0 3c 7f TimeAccelerated". Hardware accelerated encoders never use it.
+
+// ms between detents at which each acceleration index (0 - 10, same range as the MFT tables) kicks in
+static const int s_encoderAccelerationIntervals_[] = { 1000, 90, 70, 55, 45, 36, 28, 22, 16, 11, 7 };
+
+// delta multipliers for encoders that only ever send +/-1, indexed like the intervals above
+static const double s_encoderAccelerationMultipliers_[] = { 1.0, 1.0, 2.0, 2.0, 3.0, 4.0, 5.0, 6.0, 8.0, 10.0, 12.0 };
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
+class EncoderAcceleration
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
-    map<int, int> accelerationValuesForIncrement_;
-    map<int, int> accelerationValuesForDecrement_;
+    enum { MaxInterval = 128 }; // ms, anything slower is index 0
+    
+    double lastDetentTime_ = 0.0;
+    int lastDirection_ = 0;
+    
+    static const unsigned char *GetIndexForInterval()
+    {
+        static unsigned char indexForInterval[MaxInterval];
+        static bool isInitialized = false;
+        
+        if ( ! isInitialized)
+        {
+            for (int interval = 0; interval < MaxInterval; ++interval)
+            {
+                int index = 0;
+                
+                for (int i = 0; i < NUM_ELEM(s_encoderAccelerationIntervals_); ++i)
+                    if (interval <= s_encoderAccelerationIntervals_[i])
+                        index = i;
+                
+                indexForInterval[interval] = (unsigned char)index;
+            }
+            
+            isInitialized = true;
+        }
+        
+        return indexForInterval;
+    }
     
 public:
-    virtual ~AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator() {}
-    AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) :  Midi_CSIMessageGenerator(csi, widget)
+    // direction is +1 or -1, reversing always starts over at index 0
+    int GetAccelerationIndex(int direction)
     {
-        const char * const widgetClass = "RotaryWidgetClass";
-        accelerationValuesForIncrement_ = widget->GetSurface()->GetAccelerationValuesForIncrement(widgetClass);
-        accelerationValuesForDecrement_ = widget->GetSurface()->GetAccelerationValuesForDecrement(widgetClass);
-        widget->SetStepSize(widget->GetSurface()->GetStepSize(widgetClass));
-        widget->SetAccelerationValues(widget->GetSurface()->GetAccelerationValues(widgetClass));
+        const double now = time_precise();
+        int index = 0;
+        
+        if (direction == lastDirection_)
+        {
+            const double interval = (now - lastDetentTime_) * 1000.0;
+            
+            if (interval >= 0.0 && interval < MaxInterval)
+                index = GetIndexForInterval()[(int)interval];
+        }
+        
+        lastDetentTime_ = now;
+        lastDirection_ = direction;
+        
+        return index;
     }
     
+    double GetDeltaMultiplier(int direction)
+    {
+        return s_encoderAccelerationMultipliers_[GetAccelerationIndex(direction)];
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Accelerated_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // CC value -> acceleration index, positive for increments, negative (-1 - index) for decrements, NoValue if unmapped
+protected:
+    enum { NoValue = 0x7fff };
+    
+    short accelerationIndexForValue_[128];
+    
+    Accelerated_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : Midi_CSIMessageGenerator(csi, widget)
+    {
+        for (int i = 0; i < NUM_ELEM(accelerationIndexForValue_); ++i)
+            accelerationIndexForValue_[i] = NoValue;
+    }
+    
+    void SetAccelerationValues(const map<int, int> &accelerationValuesForIncrement, const map<int, int> &accelerationValuesForDecrement)
+    {
+        for (auto &value : accelerationValuesForIncrement)
+            if (value.first >= 0 && value.first < NUM_ELEM(accelerationIndexForValue_))
+                accelerationIndexForValue_[value.first] = (short)value.second;
+        
+        for (auto &value : accelerationValuesForDecrement)
+            if (value.first >= 0 && value.first < NUM_ELEM(accelerationIndexForValue_))
+                accelerationIndexForValue_[value.first] = (short)(-1 - value.second);
+    }
+    
+public:
+    virtual ~Accelerated_Midi_CSIMessageGenerator() {}
+    
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
     {
-        int val = midiMessage->midi_message[2];
+        const int index = accelerationIndexForValue_[midiMessage->midi_message[2] & 0x7f];
+        
+        if (index == NoValue)
+            return;
         
-        if (accelerationValuesForIncrement_.count(val) > 0)
-            widget_->GetZoneManager()->DoRelativeAction(widget_, accelerationValuesForIncrement_[val], 0.001);
-        else if (accelerationValuesForDecrement_.count(val) > 0)
-            widget_->GetZoneManager()->DoRelativeAction(widget_, accelerationValuesForDecrement_[val], -0.001);
+        if (index >= 0)
+            widget_->GetZoneManager()->DoRelativeAction(widget_, index, 0.001);
+        else
+            widget_->GetZoneManager()->DoRelativeAction(widget_, -1 - index, -0.001);
     }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class MFT_AcceleratedEncoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
+class AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator : public Accelerated_Midi_CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
-private:
-    map<int, int> accelerationValuesForIncrement_;
-    map<int, int> accelerationValuesForDecrement_;
+public:
+    virtual ~AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator() {}
+    AcceleratedPreconfiguredEncoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) :  Accelerated_Midi_CSIMessageGenerator(csi, widget)
+    {
+        const char * const widgetClass = "RotaryWidgetClass";
+        SetAccelerationValues(widget->GetSurface()->GetAccelerationValuesForIncrement(widgetClass), widget->GetSurface()->GetAccelerationValuesForDecrement(widgetClass));
+        widget->SetStepSize(widget->GetSurface()->GetStepSize(widgetClass));
+        widget->SetAccelerationValues(widget->GetSurface()->GetAccelerationValues(widgetClass));
+    }
+};
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class MFT_AcceleratedEncoder_Midi_CSIMessageGenerator : public Accelerated_Midi_CSIMessageGenerator
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
 public:
     virtual ~MFT_AcceleratedEncoder_Midi_CSIMessageGenerator() {}
-    MFT_AcceleratedEncoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget, vector<string> &params) : Midi_CSIMessageGenerator(csi, widget)
-    {
-        accelerationValuesForIncrement_[0x3f] = 0;
-        accelerationValuesForIncrement_[0x3e] = 1;
-        accelerationValuesForIncrement_[0x3d] = 2;
-        accelerationValuesForIncrement_[0x3c] = 3;
-        accelerationValuesForIncrement_[0x3b] = 4;
-        accelerationValuesForIncrement_[0x3a] = 5;
-        accelerationValuesForIncrement_[0x39] = 6;
-        accelerationValuesForIncrement_[0x38] = 7;
-        accelerationValuesForIncrement_[0x36] = 8;
-        accelerationValuesForIncrement_[0x33] = 9;
-        accelerationValuesForIncrement_[0x2f] = 10;
-
-        accelerationValuesForDecrement_[0x41] = 0;
-        accelerationValuesForDecrement_[0x42] = 1;
-        accelerationValuesForDecrement_[0x43] = 2;
-        accelerationValuesForDecrement_[0x44] = 3;
-        accelerationValuesForDecrement_[0x45] = 4;
-        accelerationValuesForDecrement_[0x46] = 5;
-        accelerationValuesForDecrement_[0x47] = 6;
-        accelerationValuesForDecrement_[0x48] = 7;
-        accelerationValuesForDecrement_[0x4a] = 8;
-        accelerationValuesForDecrement_[0x4d] = 9;
-        accelerationValuesForDecrement_[0x51] = 10;
-    }
-    
-    virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
+    MFT_AcceleratedEncoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget, vector<string> &params) : Accelerated_Midi_CSIMessageGenerator(csi, widget)
     {
-        int val = midiMessage->midi_message[2];
+        static const int incrementValues[] = { 0x3f, 0x3e, 0x3d, 0x3c, 0x3b, 0x3a, 0x39, 0x38, 0x36, 0x33, 0x2f };
+        static const int decrementValues[] = { 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x4a, 0x4d, 0x51 };
+        
+        for (int i = 0; i < NUM_ELEM(incrementValues); ++i)
+            accelerationIndexForValue_[incrementValues[i]] = (short)i;
         
-        if (accelerationValuesForIncrement_.count(val) > 0)
-            widget_->GetZoneManager()->DoRelativeAction(widget_, accelerationValuesForIncrement_[val], 0.001);
-        else if (accelerationValuesForDecrement_.count(val) > 0)
-            widget_->GetZoneManager()->DoRelativeAction(widget_, accelerationValuesForDecrement_[val], -0.001);
+        for (int i = 0; i < NUM_ELEM(decrementValues); ++i)
+            accelerationIndexForValue_[decrementValues[i]] = (short)(-1 - i);
     }
 };
 
@@ -208,18 +282,28 @@ public:
 class Encoder_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+private:
+    const bool isTimeAccelerated_;
+    EncoderAcceleration acceleration_;
+    
 public:
     virtual ~Encoder_Midi_CSIMessageGenerator() {}
-    Encoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : Midi_CSIMessageGenerator(csi, widget) {}
+    Encoder_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget, bool isTimeAccelerated) : Midi_CSIMessageGenerator(csi, widget), isTimeAccelerated_(isTimeAccelerated) {}
     
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
     {
-        double delta = (midiMessage->midi_message[2] & 0x3f) / 63.0;
+        const int ticks = midiMessage->midi_message[2] & 0x3f;
+        const int direction = (midiMessage->midi_message[2] & 0x40) ? -1 : 1;
+        
+        double delta = ticks / 63.0;
         
-        if (midiMessage->midi_message[2] & 0x40)
+        if (direction < 0)
             delta = -delta;
         
         delta = delta / 2.0;
+        
+        if (isTimeAccelerated_ && ticks == 1) // +/-1 only encoders (e.g. the V1-M jog) get their speed from timing instead
+            delta *= acceleration_.GetDeltaMultiplier(direction);
 
         widget_->GetZoneManager()->DoRelativeAction(widget_, delta);
     }
@@ -229,16 +313,22 @@ public:
 class EncoderPlain_Midi_CSIMessageGenerator : public Midi_CSIMessageGenerator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
+private:
+    const bool isTimeAccelerated_;
+    EncoderAcceleration acceleration_;
+    
 public:
     virtual ~EncoderPlain_Midi_CSIMessageGenerator() {}
-    EncoderPlain_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget) : Midi_CSIMessageGenerator(csi, widget) {}
+    EncoderPlain_Midi_CSIMessageGenerator(CSurfIntegrator *const csi, Widget *widget, bool isTimeAccelerated) : Midi_CSIMessageGenerator(csi, widget), isTimeAccelerated_(isTimeAccelerated) {}
     
     virtual void ProcessMidiMessage(const MIDI_event_ex_t *midiMessage) override
     {
-        double delta = 1.0 / 64.0;
+        const int direction = (midiMessage->midi_message[2] & 0x40) ? -1 : 1;
         
-        if (midiMessage->midi_message[2] & 0x40)
-            delta = -delta;
+        double delta = direction / 64.0;
+        
+        if (isTimeAccelerated_)
+            delta *= acceleration_.GetDeltaMultiplier(direction);
         
         widget_->GetZoneManager()->DoRelativeAction(widget_, delta);
     }
@@ -383,6 +473,8 @@ public:
     
     virtual const char *GetName() override { return "SCE24TwoStateLED_Midi_FeedbackProcessor"; }
 
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return SysExPriority_Button; }
+
     virtual void ForceClear() override
     {
         const PropertyList properties;
@@ -450,6 +542,7 @@ public:
     }
 
     virtual const char *GetName() override { return "SCE24OLED_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 6; }
     
     virtual void ForceClear() override
     {
@@ -562,6 +655,7 @@ public:
         lastStringSent_ = "";
     }
     virtual const char *GetName() override { return "SCE24Text_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 6; }
     
     virtual void ForceClear() override
     {
@@ -746,6 +840,8 @@ public:
     
     virtual const char *GetName() override { return "SCE24Encoder_Midi_FeedbackProcessor"; }
 
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return SysExPriority_Fader; }
+
     virtual void ForceClear() override
     {
         struct
@@ -926,6 +1022,8 @@ public:
     
     virtual const char *GetName() override { return "NovationLaunchpadMiniRGB7Bit_Midi_FeedbackProcessor"; }
 
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return SysExPriority_Button; }
+
     virtual void ForceClear() override
     {
         rgba_color color;
@@ -959,10 +1057,12 @@ public:
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x03;
         
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0x03;
+        rgba_color deviceColor = ColorPalettes::Get7BitColor(color); // only 127 bit max for this device
+        
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = midiFeedbackMessage1_.midi_message[1] ;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = color.r / 2; // only 127 bit max for this device
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = color.g / 2;
-        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = color.b / 2;
+        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = deviceColor.r;
+        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = deviceColor.g;
+        midiSysExData.evt.midi_message[midiSysExData.evt.size++] = deviceColor.b;
         
         midiSysExData.evt.midi_message[midiSysExData.evt.size++] = 0xF7;
         
@@ -999,10 +1099,12 @@ public:
     {
         lastColor_ = color;
         
+        rgba_color deviceColor = ColorPalettes::Get7BitColor(color); // only 127 bit allowed in Midi byte 3
+        
         SendMidiMessage(0x90, midiFeedbackMessage1_.midi_message[1], 0x7f);
-        SendMidiMessage(0x91, midiFeedbackMessage1_.midi_message[1], color.r / 2);  // only 127 bit allowed in Midi byte 3
-        SendMidiMessage(0x92, midiFeedbackMessage1_.midi_message[1], color.g / 2);
-        SendMidiMessage(0x93, midiFeedbackMessage1_.midi_message[1], color.b / 2);
+        SendMidiMessage(0x91, midiFeedbackMessage1_.midi_message[1], deviceColor.r);
+        SendMidiMessage(0x92, midiFeedbackMessage1_.midi_message[1], deviceColor.g);
+        SendMidiMessage(0x93, midiFeedbackMessage1_.midi_message[1], deviceColor.b);
         if (g_debugLevel >= DEBUG_LEVEL_DEBUG) {
             LogToConsole(256, "[DEBUG] [%s] ForceColorValue %d %d %d\n", widget_->GetName(), color.r, color.g, color.b);
         }
@@ -1041,9 +1143,11 @@ public:
     {
         lastColor_ = color;
         
-        SendMidiMessage(0x91, midiFeedbackMessage1_.midi_message[1], color.r / 2);  // max 127 allowed in Midi byte 3
-        SendMidiMessage(0x92, midiFeedbackMessage1_.midi_message[1], color.g / 2);
-        SendMidiMessage(0x93, midiFeedbackMessage1_.midi_message[1], color.b / 2);
+        rgba_color deviceColor = ColorPalettes::Get7BitColor(color); // max 127 allowed in Midi byte 3
+        
+        SendMidiMessage(0x91, midiFeedbackMessage1_.midi_message[1], deviceColor.r);
+        SendMidiMessage(0x92, midiFeedbackMessage1_.midi_message[1], deviceColor.g);
+        SendMidiMessage(0x93, midiFeedbackMessage1_.midi_message[1], deviceColor.b);
         if (g_debugLevel >= DEBUG_LEVEL_DEBUG) {
             LogToConsole(256, "[DEBUG] [%s] ForceColorValue %d %d %d\n", widget_->GetName(), color.r, color.g, color.b);
         }
@@ -1059,7 +1163,84 @@ public:
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class Fader14Bit_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
+class MotorFader_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Motors can't follow a new position every tick (e.g. volume automation on every channel),
+    // so positions closer than MinInterval are coalesced and moves smaller than MinDelta are held
+    // until the fader settles, see the MotorFaderFeedback section of the .mst file
+private:
+    double lastPositionSent_ = -1.0;
+    DWORD timePositionSent_ = 0;
+    bool isPositionPending_ = false;
+    bool isPendingMoveSmall_ = false;
+    double pendingPosition_ = 0.0;
+    DWORD timePositionPending_ = 0;
+    
+    static const int SettleTime = 100; // ms without a new position before a move smaller than MinDelta goes out
+    
+protected:
+    MotorFader_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1) : Midi_FeedbackProcessor(csi, surface, widget, feedback1) {}
+    
+    MotorFader_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1, MIDI_event_ex_t feedback2) : Midi_FeedbackProcessor(csi, surface, widget, feedback1, feedback2) {}
+    
+    virtual void SendPosition(double value) = 0;
+    
+    void SetPosition(double value)
+    {
+        DWORD now = GetTickCount();
+        
+        // the end stops always go out so the fader can't park just short of them
+        bool isSmall = lastPositionSent_ >= 0.0 && value != 0.0 && value != 1.0 && fabs(value - lastPositionSent_) < surface_->GetMotorFaderMinDelta();
+        
+        // the feedback dedupe won't offer this value again, so a held one has to go out later from SendPendingFeedback
+        if (isSmall || now - timePositionSent_ < (DWORD) surface_->GetMotorFaderMinInterval())
+        {
+            pendingPosition_ = value;
+            isPositionPending_ = true;
+            isPendingMoveSmall_ = isSmall;
+            timePositionPending_ = now;
+            return;
+        }
+        
+        PositionSent(value);
+        SendPosition(value);
+    }
+    
+    void ClearPendingPosition() { isPositionPending_ = false; }
+    
+    void PositionSent(double value)
+    {
+        lastPositionSent_ = value;
+        timePositionSent_ = GetTickCount();
+        isPositionPending_ = false;
+    }
+
+public:
+    virtual ~MotorFader_Midi_FeedbackProcessor() {}
+    
+    virtual const char *GetName() override { return "MotorFader_Midi_FeedbackProcessor"; }
+    
+    virtual void SendPendingFeedback() override
+    {
+        if ( ! isPositionPending_)
+            return;
+        
+        DWORD now = GetTickCount();
+        
+        if (now - timePositionSent_ < (DWORD) surface_->GetMotorFaderMinInterval())
+            return;
+        
+        if (isPendingMoveSmall_ && now - timePositionPending_ < SettleTime)
+            return;
+        
+        PositionSent(pendingPosition_);
+        SendPosition(pendingPosition_);
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class Fader14Bit_Midi_FeedbackProcessor : public MotorFader_Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
@@ -1068,7 +1249,7 @@ private:
     
 public:
     virtual ~Fader14Bit_Midi_FeedbackProcessor() {}
-    Fader14Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1) : Midi_FeedbackProcessor(csi, surface, widget, feedback1)
+    Fader14Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1) : MotorFader_Midi_FeedbackProcessor(csi, surface, widget, feedback1)
     {
         shouldSetToZero_ = false;
         timeZeroValueReceived_ = 0;
@@ -1086,6 +1267,7 @@ public:
     {
         if (shouldSetToZero_ && (GetTickCount() - timeZeroValueReceived_) > 250)
         {
+            PositionSent(0.0);
             ForceMidiMessage(midiFeedbackMessage1_.midi_message[0], 0x00, 0x00);
             shouldSetToZero_ = false;
         }
@@ -1097,24 +1279,32 @@ public:
         {
             shouldSetToZero_ = true;
             timeZeroValueReceived_ = GetTickCount();
+            ClearPendingPosition(); // the zero is handled by RunDeferredActions, an older held position mustn't follow it
             return;
         }
         else
             shouldSetToZero_ = false;
     
+        SetPosition(value);
+    }
+    
+    virtual void SendPosition(double value) override
+    {
         int volInt = int(value  *16383.0);
         SendMidiMessage(midiFeedbackMessage1_.midi_message[0], volInt&0x7f, (volInt>>7)&0x7f);
     }
     
     virtual void ForceValue(const PropertyList &properties, double value) override
     {
+        PositionSent(value);
+        
         int volInt = int(value  *16383.0);
         ForceMidiMessage(midiFeedbackMessage1_.midi_message[0], volInt&0x7f, (volInt>>7)&0x7f);
     }
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class FaderportClassicFader14Bit_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
+class FaderportClassicFader14Bit_Midi_FeedbackProcessor : public MotorFader_Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 private:
@@ -1123,7 +1313,7 @@ private:
     
 public:
     virtual ~FaderportClassicFader14Bit_Midi_FeedbackProcessor() {}
-    FaderportClassicFader14Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1, MIDI_event_ex_t feedback2) : Midi_FeedbackProcessor(csi, surface, widget, feedback1, feedback2)
+    FaderportClassicFader14Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1, MIDI_event_ex_t feedback2) : MotorFader_Midi_FeedbackProcessor(csi, surface, widget, feedback1, feedback2)
     {
         shouldSetToZero_ = false;
         timeZeroValueReceived_ = 0;
@@ -1141,6 +1331,7 @@ public:
     {
         if (shouldSetToZero_ && (GetTickCount() - timeZeroValueReceived_) > 250)
         {
+            PositionSent(0.0);
             ForceMidiMessage(midiFeedbackMessage1_.midi_message[0], midiFeedbackMessage1_.midi_message[1], 0x00);
             ForceMidiMessage(midiFeedbackMessage2_.midi_message[0], midiFeedbackMessage2_.midi_message[1], 0x00);
 
@@ -1154,11 +1345,17 @@ public:
         {
             shouldSetToZero_ = true;
             timeZeroValueReceived_ = GetTickCount();
+            ClearPendingPosition(); // the zero is handled by RunDeferredActions, an older held position mustn't follow it
             return;
         }
         else
             shouldSetToZero_ = false;
     
+        SetPosition(value);
+    }
+    
+    virtual void SendPosition(double value) override
+    {
         int volInt = int(value  *1024.0);
         
         if (midiFeedbackMessage1_.midi_message[2] != ((volInt>>7)&0x7f) || midiFeedbackMessage2_.midi_message[2] != (volInt&0x7f))
@@ -1173,6 +1370,8 @@ public:
     
     virtual void ForceValue(const PropertyList &properties, double value) override
     {
+        PositionSent(value);
+        
         int volInt = int(value  *16383.0);
         
         ForceMidiMessage(midiFeedbackMessage1_.midi_message[0], midiFeedbackMessage1_.midi_message[1], (volInt>>7)&0x7f);
@@ -1181,12 +1380,12 @@ public:
 };
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-class Fader7Bit_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
+class Fader7Bit_Midi_FeedbackProcessor : public MotorFader_Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 {
 public:
     virtual ~Fader7Bit_Midi_FeedbackProcessor() {}
-    Fader7Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1) : Midi_FeedbackProcessor(csi, surface, widget, feedback1) { }
+    Fader7Bit_Midi_FeedbackProcessor(CSurfIntegrator *const csi, Midi_ControlSurface *surface, Widget *widget, MIDI_event_ex_t feedback1) : MotorFader_Midi_FeedbackProcessor(csi, surface, widget, feedback1) { }
     
     virtual const char *GetName() override { return "Fader7Bit_Midi_FeedbackProcessor"; }
 
@@ -1197,12 +1396,18 @@ public:
     }
     
     virtual void SetValue(const PropertyList &properties, double value) override
+    {
+        SetPosition(value);
+    }
+    
+    virtual void SendPosition(double value) override
     {
         SendMidiMessage(midiFeedbackMessage1_.midi_message[0], midiFeedbackMessage1_.midi_message[1], int(value  *127.0));
     }
     
     virtual void ForceValue(const PropertyList &properties, double value) override
     {
+        PositionSent(value);
         ForceMidiMessage(midiFeedbackMessage1_.midi_message[0], midiFeedbackMessage1_.midi_message[1], int(value  *127.0));
     }
 };
@@ -1963,6 +2168,7 @@ public:
     }
     
     virtual const char *GetName() override { return "MCUDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 7; }
 
     virtual void ForceClear() override
     {
@@ -2031,6 +2237,7 @@ public:
     }
     
     virtual const char *GetName() override { return "IconDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 7; }
 
     virtual void ForceClear() override
     {
@@ -2097,6 +2304,7 @@ public:
     }
     
     virtual const char *GetName() override { return "AsparionDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return displayRow_ != 3 ? 8 : 7; }
 
     virtual void ForceClear() override
     {
@@ -2190,66 +2398,6 @@ private:
         return COLOR_INVALID;
     }
 
-    /*
-     * NOTE: Any changes made to rgbToColor here must also be mirrored in class
-     * OSC_X32FeedbackProcessor in control_surface_OSC_widgets.h
-     */
-    static int rgbToColor(int r, int g, int b)
-    {
-        // Doing a RGB to HSV conversion since HSV is better for light
-        // Converting RGB to floats between 0 and 1.0 (percentage)
-
-        float rf = (float) r / 255.0f;
-        float gf = (float) g / 255.0f;
-        float bf = (float) b / 255.0f;
-
-
-        // Hue will be between 0 and 360 to represent the color wheel.
-        // Saturation and Value are a percentage (between 0 and 1.0)
-        float h, s, v, colorMin, delta;
-        v = max(max(rf, gf), bf);
-
-        // If value is less than this percentage, LCD should be off.
-        if (v <= 0.10)
-            return COLOR_WHITE; // This could be OFF, but that would show nothing.
-
-        colorMin = min(min(rf, gf), bf);
-        delta = v - colorMin;
-        // Don't need divide by zero check since if value is 0 it will return COLOR_OFF above.
-        s = delta / v;
-
-        // If saturation is less than this percentage, LCD should be white.
-        if (s <= 0.10)
-            return COLOR_WHITE;
-
-        // Now we have a valid color. Figure out the hue and return the closest X-Touch value.
-        if (rf >= v)
-            h = (gf - bf) / delta;
-        else if (gf >= v)
-            h = ((bf - rf) / delta) + 2.0f;
-        else
-            h = ((rf - gf) / delta) + 4.0f;
-
-        h *= 60.0;
-        if (h < 0)
-            h += 360.0;
-
-        // The numbers represent the hue from 0-360.
-        if (h >= 330 || h < 20)
-            return COLOR_RED;
-        if (h >= 250)
-            return COLOR_MAGENTA;
-        if (h >= 210)
-            return COLOR_BLUE;
-        if (h >= 160)
-            return COLOR_CYAN;
-        if (h >= 80)
-            return COLOR_GREEN;
-        if (h >= 20)
-            return COLOR_YELLOW;
-
-        return COLOR_WHITE; // failsafe
-    }
         
 public:
     virtual ~XTouchDisplay_Midi_FeedbackProcessor() {}
@@ -2264,6 +2412,8 @@ public:
     }
         
     virtual const char *GetName() override { return "XTouchDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return midiMessage->midi_message[5] == 0x72 ? 6 : 7; } // colors for the whole strip : text for one channel
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return midiMessage->midi_message[5] == 0x72 ? SysExPriority_Color : SysExPriority_Display; }
 
     virtual void ForceClear() override
     {
@@ -2401,7 +2551,7 @@ public:
                 int g = color.g;
                 int b = color.b;
 
-                int surfaceColor = (int)rgbToColor(r, g, b);
+                int surfaceColor = ColorPalettes::GetScribbleStripColor(r, g, b);
                 
                 midiSysExData.evt.midi_message[midiSysExData.evt.size++] = surfaceColor;
             }
@@ -2439,6 +2589,8 @@ public:
     }
 
     virtual const char* GetName() override { return "iCON_V1MDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return midiMessage->midi_message[2] == 0x02 ? 6 : 7; } // colors for the whole strip : text for one channel
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return midiMessage->midi_message[2] == 0x02 ? SysExPriority_Color : SysExPriority_Display; }
 
     virtual void ForceClear() override
     {
@@ -2700,6 +2852,9 @@ public:
     }
 
     virtual const char* GetName() override { return "V1MTrackColors_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 6; }
+
+    virtual SysExPriority GetSysExPriority(const MIDI_event_ex_t *midiMessage) override { return SysExPriority_Color; }
 
     virtual void OverrideTrackColors(const char* colors, string const zone_name) override
     {
@@ -2752,12 +2907,7 @@ public:
         TrackColors_.clear();
         for (int i = 0; i < surface_->GetNumChannels(); ++i)
         {
-            rgba_color color = surface_->GetTrackColorForChannel(i);
-            color.r = (color.r >> 1) & 0x7F; //adjustTo7bit(color.r);
-            color.g = (color.g >> 1) & 0x7F; //adjustTo7bit(color.g);
-            color.b = (color.b >> 1) & 0x7F; //adjustTo7bit(color.b);
-            color.b = static_cast<int>(color.b * (0.70f + (0.30f * color.g / 127.0f))) & 0x7F; // Apply the blue correction for better color representation b = b * (0.70 + (0.30 * (g / 128)))
-            TrackColors_.push_back(color);
+            TrackColors_.push_back(ColorPalettes::GetV1MColor(surface_->GetTrackColorForChannel(i)));
         }
         SetTrackColors();
     }
@@ -2822,6 +2972,7 @@ public:
     }
 
     virtual const char* GetName() override { return "V1MDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 7; }
 
     virtual void ForceClear() override
     {
@@ -2900,6 +3051,7 @@ public:
     }
     
     virtual const char *GetName() override { return "FPDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 8; }
 
     virtual void ForceClear() override
     {
@@ -2998,6 +3150,7 @@ public:
     }
     
     virtual const char *GetName() override { return "FPScribbleStripMode_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 7; }
 
     virtual void ForceClear() override
     {
@@ -3058,6 +3211,7 @@ public:
     }
     
     virtual const char *GetName() override { return "QConLiteDisplay_Midi_FeedbackProcessor"; }
+    virtual int GetSysExAddressSize(const MIDI_event_ex_t *midiMessage) override { return 7; }
 
     virtual void ForceClear() override
     {
@@ -3334,190 +3488,6 @@ public:
     }
 };
 
-
-
-// Color maps are stored in Blue Green Red format
-static unsigned char s_colorMap7[128][3] = { {0, 0, 0},    // 0
-    {255, 0, 0},    // 1 - Blue
-    {255, 21, 0},    // 2 - Blue (Green Rising)
-    {255, 34, 0},
-    {255, 46, 0},
-    {255, 59, 0},
-    {255, 68, 0},
-    {255, 80, 0},
-    {255, 93, 0},
-    {255, 106, 0},
-    {255, 119, 0},
-    {255, 127, 0},
-    {255, 140, 0},
-    {255, 153, 0},
-    {255, 165, 0},
-    {255, 178, 0},
-    {255, 191, 0},
-    {255, 199, 0},
-    {255, 212, 0},
-    {255, 225, 0},
-    {255, 238, 0},
-    {255, 250, 0},    // 21 - End of Blue's Reign
-    
-    {250, 255, 0}, // 22 - Green (Blue Fading)
-    {237, 255, 0},
-    {225, 255, 0},
-    {212, 255, 0},
-    {199, 255, 0},
-    {191, 255, 0},
-    {178, 255, 0},
-    {165, 255, 0},
-    {153, 255, 0},
-    {140, 255, 0},
-    {127, 255, 0},
-    {119, 255, 0},
-    {106, 255, 0},
-    {93, 255, 0},
-    {80, 255, 0},
-    {67, 255, 0},
-    {59, 255, 0},
-    {46, 255, 0},
-    {33, 255, 0},
-    {21, 255, 0},
-    {8, 255, 0},
-    {0, 255, 0},    // 43 - Green
-    
-    {0, 255, 12},    // 44 - Green/ Red Rising
-    {0, 255, 25},
-    {0, 255, 38},
-    {0, 255, 51},
-    {0, 255, 63},
-    {0, 255, 72},
-    {0, 255, 84},
-    {0, 255, 97},
-    {0, 255, 110},
-    {0, 255, 123},
-    {0, 255, 131},
-    {0, 255, 144},
-    {0, 255, 157},
-    {0, 255, 170},
-    {0, 255, 182},
-    {0, 255, 191},
-    {0, 255, 203},
-    {0, 255, 216},
-    {0, 255, 229},
-    {0, 255, 242},
-    {0, 255, 255},    // 64 - Green + Red (Yellow)
-    
-    {0, 246, 255},    // 65 - Red, Green Fading
-    {0, 233, 255},
-    {0, 220, 255},
-    {0, 208, 255},
-    {0, 195, 255},
-    {0, 187, 255},
-    {0, 174, 255},
-    {0, 161, 255},
-    {0, 148, 255},
-    {0, 135, 255},
-    {0, 127, 255},
-    {0, 114, 255},
-    {0, 102, 255},
-    {0, 89, 255},
-    {0, 76, 255},
-    {0, 63, 255},
-    {0, 55, 255},
-    {0, 42, 255},
-    {0, 29, 255},
-    {0, 16, 255},
-    {0, 4, 255},    // 85 - End Red/Green Fading
-    
-    {4, 0, 255},    // 86 - Red/ Blue Rising
-    {16, 0, 255},
-    {29, 0, 255},
-    {42, 0, 255},
-    {55, 0, 255},
-    {63, 0, 255},
-    {76, 0, 255},
-    {89, 0, 255},
-    {102, 0, 255},
-    {114, 0, 255},
-    {127, 0, 255},
-    {135, 0, 255},
-    {148, 0, 255},
-    {161, 0, 255},
-    {174, 0, 255},
-    {186, 0, 255},
-    {195, 0, 255},
-    {208, 0, 255},
-    {221, 0, 255},
-    {233, 0, 255},
-    {246, 0, 255},
-    {255, 0, 255},    // 107 - Blue + Red
-    
-    {255, 0, 242},    // 108 - Blue/ Red Fading
-    {255, 0, 229},
-    {255, 0, 216},
-    {255, 0, 204},
-    {255, 0, 191},
-    {255, 0, 182},
-    {255, 0, 169},
-    {255, 0, 157},
-    {255, 0, 144},
-    {255, 0, 131},
-    {255, 0, 123},
-    {255, 0, 110},
-    {255, 0, 97},
-    {255, 0, 85},
-    {255, 0, 72},
-    {255, 0, 63},
-    {255, 0, 50},
-    {255, 0, 38},
-    {255, 0, 25},    // 126 - Blue-ish
-    {225, 240, 240}    // 127 - White ?
-};
-
-int GetColorIntFromRGB(int r, int g, int b)
-{
-    if (b == 0 && g == 0 && r == 0)
-        return 0;
-    else if (b > 224 && g > 239 && r > 239)
-        return 127;
-    else if (b == 255 && r == 0)
-    {
-        for (int i = 1; i < 22; ++i)
-            if (g > s_colorMap7[i - 1][1] && g <= s_colorMap7[i][1])
-                return i;
-    }
-    else if (g == 255 && r == 0)
-    {
-        for (int i = 22; i < 44; ++i)
-            if (b < s_colorMap7[i - 1][0] && b >= s_colorMap7[i][0])
-                return i;
-    }
-    else if (b == 0 && g == 255)
-    {
-        for (int i = 44; i < 65; ++i)
-            if (r > s_colorMap7[i - 1][2] && r <= s_colorMap7[i][2])
-                return i;
-    }
-    else if (b == 0 && r == 255)
-    {
-        for (int i = 65; i < 86; ++i)
-            if (g < s_colorMap7[i - 1][1] && g >= s_colorMap7[i][1])
-                return i;
-    }
-    else if (g == 0 && r == 255)
-    {
-        for (int i = 86; i < 108; ++i)
-            if (b > s_colorMap7[i - 1][0] && b <= s_colorMap7[i][0])
-                return i;
-    }
-    else if (b == 255 && g == 0)
-    {
-        for (int i = 108; i < 127; ++i)
-            if (r < s_colorMap7[i - 1][2] && r >= s_colorMap7[i][2])
-                return i;
-    }
-    
-    return 0;
-}
-
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 class MFT_RGB_Midi_FeedbackProcessor : public Midi_FeedbackProcessor
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -3552,7 +3522,7 @@ public:
             SendMidiMessage(color.r, color.g, color.b);
         else
         {
-            int colorInt = GetColorIntFromRGB(color.r, color.g, color.b);
+            int colorInt = ColorPalettes::GetMFTColor(color.r, color.g, color.b);
             // Originally, if the converted MIDI color is 0, it would send a message to turn off the LED.
             // Commenting this out prevents turning off the LED.
             if (colorInt == 0)
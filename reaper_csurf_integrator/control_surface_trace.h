@@ -0,0 +1,185 @@
+//
+//  control_surface_trace.h
+//  reaper_csurf_integrator
+//
+//  A fixed size binary trace of what went in and out of the surfaces, cheap enough to leave running.
+//  Recording is a timestamp and a 32 byte copy, no formatting and no locks. "Save trace" in the
+//  Advanced dialog dumps it to CSI/CSI.trace, tools/csi_trace_decode.cpp turns that into text or CSV.
+//
+//  This header only uses the standard library so the decoder can include it.
+//
+
+#ifndef control_surface_trace_h
+#define control_surface_trace_h
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+enum TraceEventType : uint8_t
+{
+    TraceEvent_None = 0,
+    TraceEvent_MidiIn,          // bytes = status, data1, data2
+    TraceEvent_SysExIn,         // bytes = first three, value = length
+    TraceEvent_MidiOut,
+    TraceEvent_SysExOut,
+    TraceEvent_OSCIn,           // subject = address
+    TraceEvent_OSCOut,
+    TraceEvent_ZoneActivated,   // subject = zone
+    TraceEvent_ZoneDeactivated,
+    TraceEvent_Action,          // subject = action, value = what it was given
+    TraceEvent_TickBegin,       // one Run() of the integrator
+    TraceEvent_TickEnd,
+    NumTraceEventTypes
+};
+
+static const char * const s_traceEventTypeNames[NumTraceEventTypes] =
+{
+    "None",
+    "MidiIn",
+    "SysExIn",
+    "MidiOut",
+    "SysExOut",
+    "OSCIn",
+    "OSCOut",
+    "ZoneActivated",
+    "ZoneDeactivated",
+    "Action",
+    "TickBegin",
+    "TickEnd",
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TraceEvent
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    uint64_t timestampNs;
+    uint32_t sequence;  // running event number, gaps are events that were mid write when dumped
+    uint8_t type;
+    uint8_t bytes[3];
+    int32_t source;     // symbol of the surface, 0 for the integrator
+    int32_t subject;    // symbol of the OSC address, zone or action
+    float value;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(TraceEvent) == 32, "the trace file format depends on the event size");
+
+// CSI.trace: TraceFileHeader, numSymbols x (uint16 length, name), then numEvents x TraceEvent, oldest first.
+// Native byte order, it's meant to be decoded on the machine that wrote it.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct TraceFileHeader
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    char magic[8];      // "CSITRACE"
+    uint32_t version;
+    uint32_t eventSize;
+    uint32_t numSymbols;
+    uint32_t numEvents;
+};
+
+static const char s_traceMagic[8] = { 'C', 'S', 'I', 'T', 'R', 'A', 'C', 'E' };
+static const uint32_t s_traceVersion = 1;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class TraceRing
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    // Any thread can record, a slot is claimed with one atomic increment and published by its sequence,
+    // so a dump taken while events are coming in skips the slots that are mid write.
+public:
+    static const uint32_t NumEvents = 1 << 15; // 1 MB, a few seconds of a busy session
+
+private:
+    TraceEvent events_[NumEvents];
+    atomic<uint32_t> sequences_[NumEvents]; // index + 1 of the event a slot holds, 0 while it's being written
+    atomic<uint32_t> head_;
+
+    static uint64_t GetTimestampNs()
+    {
+        return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    TraceRing() : head_(0)
+    {
+        memset(events_, 0, sizeof(events_));
+        
+        for (auto &sequence : sequences_)
+            sequence.store(0, memory_order_relaxed);
+    }
+
+    void Record(TraceEventType type, int source, int subject, double value, const unsigned char *bytes = NULL)
+    {
+        uint32_t index = head_.fetch_add(1, memory_order_relaxed);
+        uint32_t slot = index & (NumEvents - 1);
+        TraceEvent &event = events_[slot];
+
+        sequences_[slot].store(0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        event.timestampNs = GetTimestampNs();
+        event.sequence = index;
+        event.type = type;
+        event.source = source;
+        event.subject = subject;
+        event.value = (float)value;
+
+        if (bytes != NULL)
+            memcpy(event.bytes, bytes, sizeof(event.bytes));
+        else
+            memset(event.bytes, 0, sizeof(event.bytes));
+
+        sequences_[slot].store(index + 1, memory_order_release);
+    }
+
+    // writes the header, the symbols the events refer to and the events that are complete, returns the event count
+    int Dump(FILE *file, int numSymbols, const char *(*getSymbolName)(int))
+    {
+        uint32_t head = head_.load(memory_order_acquire);
+        uint32_t count = head < NumEvents ? head : NumEvents;
+
+        static TraceEvent snapshot[NumEvents];
+        uint32_t numEvents = 0;
+
+        for (uint32_t index = head - count; index != head; ++index)
+        {
+            uint32_t slot = index & (NumEvents - 1);
+
+            if (sequences_[slot].load(memory_order_acquire) != index + 1)
+                continue;
+
+            snapshot[numEvents] = events_[slot];
+            atomic_thread_fence(memory_order_acquire);
+
+            if (sequences_[slot].load(memory_order_relaxed) == index + 1) // not overwritten while copying
+                numEvents++;
+        }
+
+        TraceFileHeader header;
+        memcpy(header.magic, s_traceMagic, sizeof(header.magic));
+        header.version = s_traceVersion;
+        header.eventSize = sizeof(TraceEvent);
+        header.numSymbols = numSymbols;
+        header.numEvents = numEvents;
+        fwrite(&header, sizeof(header), 1, file);
+
+        for (int i = 0; i < numSymbols; ++i)
+        {
+            const char *name = getSymbolName(i);
+            uint16_t length = (uint16_t)strlen(name);
+            fwrite(&length, sizeof(length), 1, file);
+            fwrite(name, 1, length, file);
+        }
+
+        fwrite(snapshot, sizeof(TraceEvent), numEvents, file);
+
+        return (int)numEvents;
+    }
+};
+
+#endif /* control_surface_trace_h */
@@ -111,6 +111,8 @@
 #define IDC_CHECK_WriteFXParams         1271
 #define IDC_EDIT_DebugLevel             1272
 #define IDC_LABEL_DebugLevel            1273
+#define IDC_CHECK_ShowLatency           1317
+#define IDC_BUTTON_SaveTrace            1318
 #define IDC_COMBO_Type                  1275
 #define IDC_AcceleratedTickValuesLabel  1277
 #define IDC_AcceleratedDeltaValuesLabel 1278
@@ -134,7 +136,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        131
 #define _APS_NEXT_COMMAND_VALUE         40001
-#define _APS_NEXT_CONTROL_VALUE         1317
+#define _APS_NEXT_CONTROL_VALUE         1319
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
@@ -0,0 +1,135 @@
+//
+//  csi_trace_decode.cpp
+//  reaper_csurf_integrator
+//
+//  Turns a CSI.trace saved from the Advanced dialog into readable text or CSV.
+//  Times are milliseconds from the first event in the dump.
+//
+//  make csi_trace_decode
+//  ./csi_trace_decode [-csv] CSI.trace
+//
+
+#include <string>
+#include <vector>
+
+#include "../control_surface_trace.h"
+
+using namespace std;
+
+static const char *GetSymbol(const vector<string> &symbols, int symbol)
+{
+    return symbol > 0 && symbol < (int)symbols.size() ? symbols[symbol].c_str() : "";
+}
+
+static void PrintEvent(const TraceEvent &event, const vector<string> &symbols, uint64_t startNs, bool isCSV)
+{
+    double ms = (event.timestampNs - startNs) / 1000000.0;
+    const char *type = event.type < NumTraceEventTypes ? s_traceEventTypeNames[event.type] : "?";
+    const char *source = GetSymbol(symbols, event.source);
+    const char *subject = GetSymbol(symbols, event.subject);
+
+    char detail[128];
+    detail[0] = 0;
+
+    switch (event.type)
+    {
+        case TraceEvent_MidiIn:
+        case TraceEvent_MidiOut:
+            snprintf(detail, sizeof(detail), "%02x %02x %02x", event.bytes[0], event.bytes[1], event.bytes[2]);
+            break;
+
+        case TraceEvent_SysExIn:
+        case TraceEvent_SysExOut:
+            snprintf(detail, sizeof(detail), "%02x %02x %02x ... (%d bytes)", event.bytes[0], event.bytes[1], event.bytes[2], (int)event.value);
+            break;
+
+        case TraceEvent_OSCIn:
+        case TraceEvent_OSCOut:
+        case TraceEvent_Action:
+            snprintf(detail, sizeof(detail), "%f", event.value);
+            break;
+
+        default:
+            break;
+    }
+
+    if (isCSV)
+        printf("%u,%.3f,%s,\"%s\",\"%s\",\"%s\"\n", event.sequence, ms, type, source, subject, detail);
+    else
+        printf("%10.3f  %-16s %-20s %-32s %s\n", ms, type, source, subject, detail);
+}
+
+int main(int argc, char **argv)
+{
+    bool isCSV = false;
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if ( ! strcmp(argv[i], "-csv"))
+            isCSV = true;
+        else
+            path = argv[i];
+    }
+
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-csv] CSI.trace\n", argv[0]);
+        return 1;
+    }
+
+    FILE *traceFile = fopen(path, "rb");
+
+    if (traceFile == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    TraceFileHeader header;
+
+    if (fread(&header, sizeof(header), 1, traceFile) != 1 || memcmp(header.magic, s_traceMagic, sizeof(s_traceMagic)) != 0)
+    {
+        fprintf(stderr, "%s is not a CSI trace\n", path);
+        fclose(traceFile);
+        return 1;
+    }
+
+    if (header.version != s_traceVersion || header.eventSize != sizeof(TraceEvent))
+    {
+        fprintf(stderr, "%s is trace version %u with %u byte events, this decoder reads version %u\n", path, header.version, header.eventSize, s_traceVersion);
+        fclose(traceFile);
+        return 1;
+    }
+
+    vector<string> symbols;
+
+    for (uint32_t i = 0; i < header.numSymbols; ++i)
+    {
+        uint16_t length = 0;
+        string name;
+
+        if (fread(&length, sizeof(length), 1, traceFile) == 1)
+        {
+            name.resize(length);
+
+            if (length > 0 && fread(&name[0], 1, length, traceFile) != length)
+                name.clear();
+        }
+
+        symbols.push_back(name);
+    }
+
+    vector<TraceEvent> events(header.numEvents);
+
+    size_t numEvents = header.numEvents > 0 ? fread(&events[0], sizeof(TraceEvent), header.numEvents, traceFile) : 0;
+    fclose(traceFile);
+
+    if (isCSV)
+        printf("sequence,ms,type,surface,subject,detail\n");
+
+    for (size_t i = 0; i < numEvents; ++i)
+        PrintEvent(events[i], symbols, events[0].timestampNs, isCSV);
+
+    return 0;
+}
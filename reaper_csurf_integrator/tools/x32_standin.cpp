@@ -0,0 +1,231 @@
+//
+//  x32_standin.cpp
+//  reaper_csurf_integrator
+//
+//  A stand-in for a Behringer X32 console, for working on the X32 surface without the hardware.
+//  It answers /xinfo and value queries, pushes changes to the clients that sent /xremote or /xremotenfb
+//  within the last 10 seconds, and can move faders on its own to measure what CSI receives.
+//
+//  make x32_standin
+//  ./x32_standin [-port 10023] [-firmware 4.06] [-moves perSecond]
+//
+
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <iostream>
+#include <unistd.h>
+
+#include "../oscpkt.hh"
+#include "../udp.hh"
+
+using namespace std;
+using namespace oscpkt;
+
+static const int s_clientExpiryMs = 10000;
+static const int s_numChannels = 32;
+
+static long long NowMs()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Client
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+    SockAddr address;
+    bool isNoFeedback = false; // /xremotenfb, don't echo the client's own changes back to it
+    long long lastRenewalMs = 0;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+class X32StandIn
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+{
+private:
+    UdpSocket socket_;
+    string firmware_;
+    map<string, Message> parameters_; // the last value set per address, sent back as is
+    vector<Client> clients_;
+    
+    int received_ = 0;
+    int sent_ = 0;
+    
+    void Send(const Message &message, SockAddr &address)
+    {
+        PacketWriter writer;
+        writer.addMessage(message);
+        socket_.sendPacketTo(writer.packetData(), writer.packetSize(), address);
+        sent_++;
+    }
+    
+    void Push(const Message &message, const SockAddr *origin)
+    {
+        long long now = NowMs();
+        
+        for (auto &client : clients_)
+        {
+            if (now - client.lastRenewalMs > s_clientExpiryMs)
+                continue;
+            
+            if (origin != NULL && client.isNoFeedback && client.address.asString() == origin->asString())
+                continue;
+            
+            Send(message, client.address);
+        }
+    }
+    
+    void Renew(SockAddr &origin, bool isNoFeedback)
+    {
+        for (auto &client : clients_)
+        {
+            if (client.address.asString() == origin.asString())
+            {
+                client.isNoFeedback = isNoFeedback;
+                client.lastRenewalMs = NowMs();
+                return;
+            }
+        }
+        
+        Client client;
+        client.address = origin;
+        client.isNoFeedback = isNoFeedback;
+        client.lastRenewalMs = NowMs();
+        clients_.push_back(client);
+        
+        printf("client %s%s\n", origin.asString().c_str(), isNoFeedback ? " (nfb)" : "");
+    }
+    
+    void HandleMessage(Message *message, SockAddr &origin)
+    {
+        received_++;
+        
+        const string &address = message->addressPattern();
+        
+        if (address == "/xremote" || address == "/xremotenfb")
+        {
+            Renew(origin, address == "/xremotenfb");
+        }
+        else if (address == "/xinfo")
+        {
+            Message reply("/xinfo");
+            reply.pushStr("127.0.0.1").pushStr("x32_standin").pushStr("X32").pushStr(firmware_);
+            Send(reply, origin);
+        }
+        else if (message->arg().nbArgRemaining() == 0)
+        {
+            auto it = parameters_.find(address);
+            
+            if (it != parameters_.end())
+                Send(it->second, origin);
+        }
+        else
+        {
+            parameters_[address] = *message;
+            Push(*message, &origin);
+        }
+    }
+    
+public:
+    X32StandIn(const string &firmware) : firmware_(firmware) {}
+    
+    bool Open(int port)
+    {
+        if ( ! socket_.bindTo(port))
+        {
+            printf("could not bind to port %d: %s\n", port, socket_.errorMessage().c_str());
+            return false;
+        }
+        
+        printf("listening on %d, firmware %s\n", port, firmware_.c_str());
+        return true;
+    }
+    
+    void Run(int movesPerSecond)
+    {
+        mt19937 generator(32);
+        uniform_int_distribution<int> channels(1, s_numChannels);
+        uniform_real_distribution<float> values(0.0f, 1.0f);
+        
+        long long lastMoveMs = NowMs();
+        long long lastReportMs = NowMs();
+        
+        PacketReader reader;
+        
+        while (socket_.isOk())
+        {
+            if (socket_.receiveNextPacket(5))
+            {
+                reader.init(socket_.packetData(), socket_.packetSize());
+                
+                Message *message = NULL;
+                while (reader.isOk() && (message = reader.popMessage()) != NULL)
+                    HandleMessage(message, socket_.packetOrigin());
+            }
+            
+            long long now = NowMs();
+            
+            if (movesPerSecond > 0)
+            {
+                int moves = (int)((now - lastMoveMs) * movesPerSecond / 1000);
+                
+                if (moves > 0)
+                {
+                    lastMoveMs = now;
+                    
+                    for (int i = 0; i < moves; ++i)
+                    {
+                        char address[32];
+                        snprintf(address, sizeof(address), "/ch/%02d/mix/fader", channels(generator));
+                        
+                        Message message(address);
+                        message.pushFloat(values(generator));
+                        parameters_[address] = message;
+                        Push(message, NULL);
+                    }
+                }
+            }
+            
+            if (now - lastReportMs >= 1000)
+            {
+                if (received_ > 0 || sent_ > 0)
+                    printf("rx %d msg/s  tx %d msg/s  %d parameters\n", received_, sent_, (int)parameters_.size());
+                
+                fflush(stdout);
+                
+                received_ = 0;
+                sent_ = 0;
+                lastReportMs = now;
+            }
+        }
+    }
+};
+
+int main(int argc, char **argv)
+{
+    int port = 10023;
+    string firmware = "4.06";
+    int movesPerSecond = 0;
+    
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if ( ! strcmp(argv[i], "-port"))
+            port = atoi(argv[i + 1]);
+        else if ( ! strcmp(argv[i], "-firmware"))
+            firmware = argv[i + 1];
+        else if ( ! strcmp(argv[i], "-moves"))
+            movesPerSecond = atoi(argv[i + 1]);
+    }
+    
+    X32StandIn standIn(firmware);
+    
+    if ( ! standIn.Open(port))
+        return 1;
+    
+    standIn.Run(movesPerSecond);
+    
+    return 0;
+}